@@ -4,12 +4,17 @@ out vec4 oColor;
 in vec3 sNormal;
 in vec2 sTexCoord;
 
-uniform vec3 uSunDir;
-uniform vec4 uSunCol;
+// per frame data, see gfx::renderer.
+layout(std140, binding = 0) uniform Frame {
+	mat4 uViewProjection;
+	vec4 uSunDir;
+	vec4 uSunCol;
+};
+
 uniform sampler2D uTexture;
 
 void main() {
-	float shade = clamp(dot(uSunDir, sNormal), 0.1, 1.0);
+	float shade = clamp(dot(uSunDir.xyz, sNormal), 0.1, 1.0);
 	vec3 shadeColor = uSunCol.xyz * shade * uSunCol.w;
 	vec3 color = texture(uTexture, sTexCoord).rgb * shadeColor;
 	oColor = vec4(color, 1.0);
@@ -1,15 +1,59 @@
-#version 450 core
+#version 460 core
 layout(location = 0) in vec3 iPosition;
-layout(location = 1) in vec3 iNormal;
+layout(location = 1) in vec4 iNormal;
 layout(location = 2) in vec2 iTexCoord;
 
-uniform mat4 uTransform;
+// per frame data, see gfx::renderer.
+layout(std140, binding = 0) uniform Frame {
+	mat4 uViewProjection;
+	vec4 uSunDir;
+	vec4 uSunCol;
+};
+
+// per object data of draws that don't use uDraws below.
+layout(std140, binding = 1) uniform Object { mat4 uModel; };
+
+// vertex format decode, see gfx::vertex_format.
+layout(location = 16) uniform vec3 uPositionScale = vec3(1.0);
+layout(location = 17) uniform vec3 uPositionOffset = vec3(0.0);
+layout(location = 18) uniform bool uOctahedralNormal = false;
+
+// per draw data of multi draws, see gfx::renderer::flush. used instead of the
+// uniforms above when uDrawBase isn't negative.
+struct DrawData {
+	mat4 transform;
+	vec4 positionScale;
+	vec4 positionOffset; // w is 1 for octahedral normals.
+};
+layout(std430, binding = 0) readonly buffer Draws { DrawData uDraws[]; };
+layout(location = 19) uniform int uDrawBase = -1;
 
 out vec3 sNormal;
 out vec2 sTexCoord;
 
+vec3 octahedralDecode(vec2 o) {
+	vec3 n = vec3(o, 1.0 - abs(o.x) - abs(o.y));
+	if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
 void main() {
-	sNormal = iNormal;
+	mat4 transform;
+	vec3 positionScale, positionOffset;
+	bool octahedralNormal;
+	if(uDrawBase >= 0) {
+		DrawData draw = uDraws[uDrawBase + gl_DrawID];
+		transform = draw.transform;
+		positionScale = draw.positionScale.xyz;
+		positionOffset = draw.positionOffset.xyz;
+		octahedralNormal = draw.positionOffset.w != 0.0;
+	} else {
+		transform = uViewProjection * uModel;
+		positionScale = uPositionScale;
+		positionOffset = uPositionOffset;
+		octahedralNormal = uOctahedralNormal;
+	}
+	sNormal = octahedralNormal ? octahedralDecode(iNormal.xy) : iNormal.xyz;
 	sTexCoord = iTexCoord;
-	gl_Position = uTransform * vec4(iPosition, 1.0);
+	gl_Position = transform * vec4(positionOffset + positionScale * iPosition, 1.0);
 }
@@ -0,0 +1,36 @@
+#version 450 core
+layout(location = 0) in vec3 iPosition;
+layout(location = 1) in vec4 iNormal;
+layout(location = 2) in vec2 iTexCoord;
+
+// per frame data, see gfx::renderer.
+layout(std140, binding = 0) uniform Frame {
+	mat4 uViewProjection;
+	vec4 uSunDir;
+	vec4 uSunCol;
+};
+
+// vertex format decode, see gfx::vertex_format.
+layout(location = 16) uniform vec3 uPositionScale = vec3(1.0);
+layout(location = 17) uniform vec3 uPositionOffset = vec3(0.0);
+layout(location = 18) uniform bool uOctahedralNormal = false;
+
+// model matrix of every instance, see gfx::renderer::render_instanced.
+layout(std430, binding = 1) readonly buffer Instances { mat4 uInstances[]; };
+
+out vec3 sNormal;
+out vec2 sTexCoord;
+
+vec3 octahedralDecode(vec2 o) {
+	vec3 n = vec3(o, 1.0 - abs(o.x) - abs(o.y));
+	if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+void main() {
+	mat4 model = uInstances[gl_InstanceID];
+	vec3 normal = uOctahedralNormal ? octahedralDecode(iNormal.xy) : iNormal.xyz;
+	sNormal = normalize(mat3(model) * normal);
+	sTexCoord = iTexCoord;
+	gl_Position = uViewProjection * model * vec4(uPositionOffset + uPositionScale * iPosition, 1.0);
+}
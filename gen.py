@@ -1,6 +1,6 @@
 import configparser as cfgp, re
 import glob
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from typing import Any, MutableMapping
 from collections import ChainMap
 
@@ -57,6 +57,7 @@ class Rule:
 	ins: list[str]
 	pat: str | None
 	out: list[str] | None
+	deps: list[str] = field(default_factory=list) # implicit dependencies.
 	
 	@property
 	def has_outs(self) -> bool:
@@ -104,6 +105,8 @@ for rule in p["rules"]:
 				r.out.extend(y.split())
 	elif opt == 'pat':
 		r.pat = v
+	elif opt == 'deps':
+		r.deps = Tstr(v).eval(ns, global_ns).split()
 	else:
 		print(f"bad opt {opt} (in {name}.{opt})")
 		exit(1)
@@ -133,14 +136,15 @@ with open('build.ninja', 'w') as fout:
 		if os is None:
 			print(f"can't compute outs of {name}")
 			exit(1)
+		deps = f' | {" ".join(r.deps)}' if r.deps else ''
 		if len(os) == 1:
 			fout.write(f'build {os[0]}: {name}')
 			for i in r.ins:
 				fout.write(f' {i}')
-			fout.write('\n')
+			fout.write(f'{deps}\n')
 		else:
 			for i, o in zip(r.ins, os):
-				fout.write(f'build {o}: {name} {i}\n')
+				fout.write(f'build {o}: {name} {i}{deps}\n')
 	fout.write('\n')
 	
 	
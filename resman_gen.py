@@ -0,0 +1,91 @@
+# compiles a resource manifest (data/resman.json) into the binary
+# format read by res::res_manager::load_from_binary.
+#
+# layout (little-endian):
+#   header:    magic "GRM1", u32 version, u32 provider count,
+#              u32 entry count, u32 string table size.
+#   providers: provider count * (u32 offset, u32 length).
+#   entries:   entry count * (u8[16] uuid, u32 provider index,
+#              u32 path offset, u32 path length,
+#              u32 name offset, u32 name length), sorted by uuid.
+#              name offset is 0xffffffff for unnamed resources.
+#   strings:   interned string bytes, offsets are relative to
+#              the start of this table.
+import json, struct, sys, uuid
+
+MAGIC = b'GRM1'
+VERSION = 1
+NO_NAME = 0xffffffff
+
+class StringTable:
+	def __init__(self):
+		self.data = bytearray()
+		self.offsets: dict[str, int] = {}
+
+	def intern(self, s: str) -> tuple[int, int]:
+		b = s.encode('utf-8')
+		if s not in self.offsets:
+			self.offsets[s] = len(self.data)
+			self.data += b
+		return self.offsets[s], len(b)
+
+
+def fail(message: str):
+	print(f'{sys.argv[0]}: {message}', file=sys.stderr)
+	exit(1)
+
+
+def compile_manifest(manifest) -> bytes:
+	if not isinstance(manifest, dict) or not isinstance(manifest.get('resources'), list):
+		fail("expected an object with a 'resources' array")
+
+	strings = StringTable()
+	providers: list[str] = []
+	entries = []
+	seen: set[bytes] = set()
+
+	for item in manifest['resources']:
+		for key in ('provider', 'uuid', 'path'):
+			if not isinstance(item.get(key), str):
+				fail(f"resource without string '{key}': {item}")
+		try:
+			uid = uuid.UUID(item['uuid']).bytes
+		except ValueError:
+			fail(f"invalid UUID: '{item['uuid']}'")
+		if uid in seen:
+			fail(f"duplicate UUID: '{item['uuid']}'")
+		seen.add(uid)
+
+		if item['provider'] not in providers:
+			providers.append(item['provider'])
+		provider = providers.index(item['provider'])
+
+		path = strings.intern(item['path'])
+		name = (NO_NAME, 0)
+		if 'name' in item:
+			if not isinstance(item['name'], str):
+				fail(f"non-string name: {item['name']}")
+			name = strings.intern(item['name'])
+
+		entries.append((uid, provider, *path, *name))
+
+	provider_strings = [strings.intern(p) for p in providers]
+	entries.sort(key=lambda e: e[0])
+
+	out = bytearray()
+	out += struct.pack('<4sIIII', MAGIC, VERSION, len(providers), len(entries), len(strings.data))
+	for offset, length in provider_strings:
+		out += struct.pack('<II', offset, length)
+	for entry in entries:
+		out += struct.pack('<16sIIIII', *entry)
+	out += strings.data
+	return bytes(out)
+
+
+if __name__ == '__main__':
+	if len(sys.argv) != 3:
+		fail('usage: resman_gen.py <manifest.json> <output.bin>')
+	with open(sys.argv[1]) as fin:
+		manifest = json.load(fin)
+	with open(sys.argv[2], 'wb') as fout:
+		fout.write(compile_manifest(manifest))
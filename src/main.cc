@@ -25,12 +25,37 @@
 #include <utility>
 #include <unordered_map>
 #include <set>
-// #include <chrono>
+#include <map>
+#include <bitset>
+#include <chrono>
+#include <any>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <charconv>
+#include <numeric>
+#include <bit>
+#include <ranges>
+#include <stdexcept>
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace stdfs = std::filesystem;
 namespace nmann = nlohmann;
 using namespace std::literals;
-// namespace stdch = std::chrono;
+namespace stdch = std::chrono;
 
 /* null-terminated string view. (alias) */
 using strv = std::string_view;
@@ -221,7 +246,23 @@ namespace util {
 		std::fputc('\n', stderr);
 	}
 
+	/* thrown by `fail` instead of exiting while a `recoverable_failures` is
+	 * alive on the calling thread, e.g. while hot reloading a resource. */
+	struct failure : std::runtime_error {
+		failure() : std::runtime_error("failed") {}
+	};
+
+	thread_local int recoverable_failures_ = 0;
+
+	struct recoverable_failures {
+		recoverable_failures() { ++recoverable_failures_; }
+		~recoverable_failures() { --recoverable_failures_; }
+		recoverable_failures(const recoverable_failures &) = delete;
+		recoverable_failures &operator=(const recoverable_failures &) = delete;
+	};
+
 	void fail() {
+		if(recoverable_failures_ > 0) throw failure();
 		exit(1);
 	}
 
@@ -248,17 +289,415 @@ namespace util {
 		return "unknown";
 	};
 
+	/* 64-bit fnv-1a, usable at compile time. */
+	constexpr uint64_t hash_string(strv s) {
+		uint64_t h = 0xcbf29ce484222325;
+		for(char c : s) {
+			h ^= (uint8_t)c;
+			h *= 0x100000001b3;
+		}
+		return h;
+	}
+
+	/* hashed string, copied and compared as a single integer. the text is only
+	 * kept in a global table by `intern`, for printing. `"name"_sid` hashes at
+	 * compile time. */
+	class string_id {
+		uint64_t value_ = 0;
+
+		static auto &table_() {
+			static struct {
+				std::mutex mutex;
+				std::unordered_map<uint64_t, std::string> strings;
+			} table;
+			return table;
+		}
+	public:
+		constexpr string_id() = default;
+		constexpr explicit string_id(strv s) : value_(hash_string(s)) {}
+
+		/* hash `s` and remember its text, fails on a hash collision. */
+		static string_id intern(strv s) {
+			string_id sid(s);
+			auto &table = table_();
+			std::lock_guard lock(table.mutex);
+			auto [it, inserted] = table.strings.try_emplace(sid.value_, s);
+			if(!inserted && it->second != s)
+				::util::fail_error("String id collision: '{}' and '{}'.", it->second, s);
+			return sid;
+		}
+
+		/* `string_id(s)` for call sites that may be hot. it is only interned
+		 * when building with GAEM_DEBUG_NAMES, to print its text later without
+		 * taking the table lock on every call otherwise. */
+		static string_id of(strv s) {
+#ifdef GAEM_DEBUG_NAMES
+			return intern(s);
+#else
+			return string_id(s);
+#endif
+		}
+
+		/* interned text, or the hash in hex if the string was never interned. */
+		std::string str() const {
+			auto &table = table_();
+			std::lock_guard lock(table.mutex);
+			auto it = table.strings.find(value_);
+			if(it != table.strings.end()) return it->second;
+			return fmt::format("#{:016x}", value_);
+		}
+
+		constexpr uint64_t value() const { return value_; }
+		constexpr bool operator==(const string_id &) const = default;
+
+		struct hash {
+			std::size_t operator()(const string_id &sid) const { return sid.value_; }
+		};
+	};
+
+	/* bytes read from disk by the calling thread, for load statistics. */
+	thread_local size_t bytes_read = 0;
+
+	/* small sequential id of the calling thread, the first thread to ask gets 0. */
+	uint32_t thread_index() {
+		static std::atomic<uint32_t> next = 0;
+		thread_local uint32_t index = next++;
+		return index;
+	}
+
 	auto read_file(const stdfs::path &path) -> std::vector<char> {
 		std::vector<char> v(stdfs::file_size(path));
+		bytes_read += v.size();
 		auto stream = std::ifstream(path);
 		stream.exceptions(std::ios_base::badbit);
 		stream.read(v.data(), v.size());
 		return v;
 	}
+
+	/* read-only memory mapping of a whole file. */
+	class mapped_file {
+		const std::byte *data_ = nullptr;
+		size_t size_ = 0;
+	public:
+		mapped_file() {}
+
+		/* `populate` faults all pages in right away, to do the disk reads up front. */
+		explicit mapped_file(const stdfs::path &path, bool populate = false) {
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if(fd < 0) fail_error("Failed to open file: {}", path);
+			struct stat st;
+			if(::fstat(fd, &st) != 0) fail_error("Failed to stat file: {}", path);
+			size_ = st.st_size;
+			bytes_read += size_;
+			if(size_ > 0) {
+				void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+				if(p == MAP_FAILED) fail_error("Failed to map file: {}", path);
+				data_ = (const std::byte*)p;
+			}
+			::close(fd);
+		}
+
+		mapped_file(mapped_file &&other)
+			: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+		mapped_file &operator=(mapped_file &&other) {
+			std::swap(data_, other.data_);
+			std::swap(size_, other.size_);
+			return *this;
+		}
+
+		~mapped_file() {
+			if(data_ != nullptr) ::munmap((void*)data_, size_);
+		}
+
+		const std::byte *data() const { return data_; }
+		size_t size() const { return size_; }
+		std::span<const std::byte> bytes() const { return { data_, size_ }; }
+	};
+
+	/* reports files written or moved into watched directories, using inotify. */
+	class file_watcher {
+		int fd_;
+		std::unordered_map<int, stdfs::path> dirs_; /* watch descriptor to directory. */
+		std::unordered_map<std::string, int> watches_; /* directory to watch descriptor. */
+	public:
+		file_watcher() {
+			fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if(fd_ < 0) fail_error("Failed to initialize inotify.");
+		}
+
+		file_watcher(const file_watcher &) = delete;
+		file_watcher &operator=(const file_watcher &) = delete;
+
+		~file_watcher() { ::close(fd_); }
+
+		/* watch a directory, does nothing if it is already watched. */
+		void watch_directory(const stdfs::path &dir) {
+			auto key = dir.lexically_normal().string();
+			if(watches_.contains(key)) return;
+			// editors often write a new file and rename it over the old one, so also watch moves.
+			int wd = inotify_add_watch(fd_, key.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if(wd < 0) {
+				print_error("Failed to watch directory: {}", dir);
+				return;
+			}
+			watches_.emplace(key, wd);
+			dirs_.emplace(wd, key);
+		}
+
+		/* paths (lexically normal) of files changed since the last poll, without blocking. */
+		std::vector<stdfs::path> poll() {
+			std::vector<stdfs::path> changed;
+			alignas(inotify_event) char buffer[4096];
+			for(;;) {
+				ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+				if(n <= 0) break;
+				for(char *p = buffer; p < buffer + n; ) {
+					auto *event = (const inotify_event*)p;
+					if(event->len > 0) {
+						if(auto it = dirs_.find(event->wd); it != dirs_.end()) {
+							auto path = (it->second / event->name).lexically_normal();
+							if(std::find(changed.begin(), changed.end(), path) == changed.end())
+								changed.push_back(std::move(path));
+						}
+					}
+					p += sizeof(inotify_event) + event->len;
+				}
+			}
+			return changed;
+		}
+	};
+
+	/* run `f(i)` for every i in [0, count), each on its own thread (the calling
+	 * thread takes 0). spawns threads on every call, so only for coarse work. */
+	template<typename F>
+	void parallel_for(size_t count, F &&f) {
+		std::vector<std::thread> threads;
+		for(size_t i = 1; i < count; ++i)
+			threads.emplace_back([&f, i] { f(i); });
+		if(count > 0) f(0);
+		for(auto &thread : threads) thread.join();
+	}
+
+	/* fixed set of worker threads running submitted jobs in fifo order. */
+	class thread_pool {
+		std::vector<std::thread> workers_;
+		std::deque<std::function<void()>> jobs_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stopping_ = false;
+
+		void run_() {
+			for(;;) {
+				std::function<void()> job;
+				{
+					std::unique_lock lock(mutex_);
+					cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+					if(jobs_.empty()) return; // stopping and nothing left to do.
+					job = std::move(jobs_.front());
+					jobs_.pop_front();
+				}
+				job();
+			}
+		}
+	public:
+		/* by default leave one hardware thread for the render thread. */
+		static size_t default_size() {
+			size_t n = std::thread::hardware_concurrency();
+			return n > 1 ? n - 1 : 1;
+		}
+
+		explicit thread_pool(size_t count = default_size()) {
+			workers_.reserve(count);
+			for(size_t i = 0; i < count; ++i)
+				workers_.emplace_back([this] { run_(); });
+		}
+
+		thread_pool(const thread_pool &) = delete;
+		thread_pool &operator=(const thread_pool &) = delete;
+
+		/* finishes all queued jobs before joining. */
+		~thread_pool() {
+			{
+				std::lock_guard lock(mutex_);
+				stopping_ = true;
+			}
+			cv_.notify_all();
+			for(auto &worker : workers_) worker.join();
+		}
+
+		void submit(std::function<void()> job) {
+			{
+				std::lock_guard lock(mutex_);
+				jobs_.push_back(std::move(job));
+			}
+			cv_.notify_one();
+		}
+
+		size_t size() const { return workers_.size(); }
+	};
+
+	/* uninitialized fixed-size slots for objects of type T, allocated in chunks
+	 * that are never moved or freed until the pool dies. free slots are reused
+	 * in lifo order, so after warming up allocating a slot is allocation-free. */
+	template<typename T, size_t ChunkSize = 64>
+	class slot_pool {
+		struct chunk {
+			alignas(T) std::byte storage[ChunkSize * sizeof(T)];
+			std::bitset<ChunkSize> used;
+		};
+
+		std::vector<std::unique_ptr<chunk>> chunks_;
+		std::vector<size_t> free_; /* free slot indices. */
+		size_t count_ = 0; /* used slots. */
+
+		chunk &chunk_of_(size_t slot) { return *chunks_[slot / ChunkSize]; }
+	public:
+		static constexpr size_t chunk_size = ChunkSize;
+
+		/* reserve a slot. the storage is uninitialized, but the slot already
+		 * counts as used, see `for_each`. */
+		size_t allocate() {
+			if(free_.empty()) {
+				size_t base = chunks_.size() * ChunkSize;
+				chunks_.push_back(std::make_unique<chunk>());
+				free_.reserve(free_.size() + ChunkSize);
+				for(size_t i = ChunkSize; i > 0; --i)
+					free_.push_back(base + i - 1); // lowest index on top.
+			}
+			size_t slot = free_.back();
+			free_.pop_back();
+			chunk_of_(slot).used.set(slot % ChunkSize);
+			++count_;
+			return slot;
+		}
+
+		/* release a slot. the object in it must already be destroyed. */
+		void deallocate(size_t slot) {
+			assert(chunk_of_(slot).used.test(slot % ChunkSize) && "double free of pool slot");
+			chunk_of_(slot).used.reset(slot % ChunkSize);
+			free_.push_back(slot);
+			--count_;
+		}
+
+		std::byte *get(size_t slot) {
+			return chunk_of_(slot).storage + (slot % ChunkSize) * sizeof(T);
+		}
+
+		size_t count() const { return count_; }
+		size_t capacity() const { return chunks_.size() * ChunkSize; }
+
+		/* call `f(T&)` for every used slot, in memory order. a slot is used from
+		 * `allocate` on, before the caller constructs a T in it, so this must
+		 * not run between allocating a slot and constructing its object. */
+		template<typename F>
+		void for_each(F &&f) {
+			for(auto &c : chunks_) {
+				for(size_t i = 0; i < ChunkSize; ++i) {
+					if(c->used.test(i))
+						f(*std::launder((T*)(c->storage + i * sizeof(T))));
+				}
+			}
+		}
+	};
+
+	/* hands out ranges of a space of `capacity` units, e.g. a gpu buffer. the
+	 * smallest free range that fits is used, and freed ranges are merged with
+	 * their free neighbours. */
+	class range_allocator {
+		std::map<size_t, size_t> free_by_offset_; /* offset -> size. */
+		std::set<std::pair<size_t, size_t>> free_by_size_; /* (size, offset). */
+		size_t capacity_ = 0, used_ = 0;
+
+		void insert_(size_t offset, size_t size) {
+			free_by_offset_.emplace(offset, size);
+			free_by_size_.emplace(size, offset);
+		}
+
+		void erase_(std::map<size_t, size_t>::iterator it) {
+			free_by_size_.erase({ it->second, it->first });
+			free_by_offset_.erase(it);
+		}
+	public:
+		explicit range_allocator(size_t capacity = 0) { grow(capacity); }
+
+		/* the offset of `size` free units aligned to `alignment`, if there are. */
+		std::optional<size_t> allocate(size_t size, size_t alignment = 1) {
+			assert(size > 0 && alignment > 0);
+			for(auto it = free_by_size_.lower_bound({ size, 0 }); it != free_by_size_.end(); ++it) {
+				auto [range_size, offset] = *it;
+				size_t aligned = (offset + alignment - 1) / alignment * alignment;
+				if(aligned + size > offset + range_size) continue;
+				erase_(free_by_offset_.find(offset));
+				if(aligned > offset) insert_(offset, aligned - offset);
+				if(aligned + size < offset + range_size) insert_(aligned + size, offset + range_size - aligned - size);
+				used_ += size;
+				return aligned;
+			}
+			return std::nullopt;
+		}
+
+		void free(size_t offset, size_t size) {
+			assert(size <= used_ && offset + size <= capacity_);
+			used_ -= size;
+			if(auto next = free_by_offset_.find(offset + size); next != free_by_offset_.end()) {
+				size += next->second;
+				erase_(next);
+			}
+			if(auto prev = free_by_offset_.lower_bound(offset); prev != free_by_offset_.begin()) {
+				--prev;
+				assert(prev->first + prev->second <= offset && "double free of range");
+				if(prev->first + prev->second == offset) {
+					offset = prev->first;
+					size += prev->second;
+					erase_(prev);
+				}
+			}
+			insert_(offset, size);
+		}
+
+		/* add free units at the end. */
+		void grow(size_t new_capacity) {
+			if(new_capacity <= capacity_) return;
+			size_t old = capacity_;
+			capacity_ = new_capacity;
+			used_ += new_capacity - old;
+			free(old, new_capacity - old);
+		}
+
+		size_t capacity() const { return capacity_; }
+		size_t used() const { return used_; }
+	};
+
+	/* stable sort of `items` by their 64-bit `key`, a byte at a time from the
+	 * lowest. all eight histograms are counted in one pass, and bytes every key
+	 * shares are skipped. `scratch` is only kept to reuse its memory. */
+	template<typename T>
+	void radix_sort(std::vector<T> &items, std::vector<T> &scratch) {
+		if(items.size() < 2) return;
+		std::array<std::array<uint32_t, 256>, 8> counts {};
+		for(const auto &item : items)
+			for(int b = 0; b < 8; ++b) ++counts[b][item.key >> (b * 8) & 0xff];
+		scratch.resize(items.size());
+		for(int b = 0; b < 8; ++b) {
+			auto &count = counts[b];
+			if(count[items[0].key >> (b * 8) & 0xff] == items.size()) continue;
+			uint32_t sum = 0;
+			for(auto &c : count) sum += std::exchange(c, sum);
+			for(const auto &item : items) scratch[count[item.key >> (b * 8) & 0xff]++] = item;
+			items.swap(scratch);
+		}
+	}
+}
+
+/* compile-time `util::string_id`, e.g. `"material.default"_sid`. */
+consteval util::string_id operator""_sid(const char *s, size_t n) {
+	return util::string_id(strv(s, n));
 }
 
 namespace util::json {
 	nmann::json read_file(const stdfs::path &path) {
+		::util::bytes_read += stdfs::file_size(path);
 		std::ifstream inp(path);
 		inp.exceptions(std::ios_base::badbit);
 		return nmann::json::parse(inp);
@@ -325,9 +764,48 @@ namespace util::json {
 namespace res {
 	class res_manager;
 
+	/* memory held by a loaded resource, on the cpu and on the gpu. */
+	struct res_usage {
+		size_t cpu_bytes = 0;
+		size_t gpu_bytes = 0;
+
+		res_usage &operator+=(const res_usage &other) {
+			cpu_bytes += other.cpu_bytes;
+			gpu_bytes += other.gpu_bytes;
+			return *this;
+		}
+
+		res_usage &operator-=(const res_usage &other) {
+			cpu_bytes -= other.cpu_bytes;
+			gpu_bytes -= other.gpu_bytes;
+			return *this;
+		}
+	};
+
+	/* where the time and memory of one resource load went. times are in
+	 * microseconds since the manager was created. */
+	struct load_record {
+		std::string resource, provider;
+		bool async = false;
+		uint32_t stage_thread = 0, load_thread = 0; /* see `util::thread_index`. */
+		uint64_t stage_start = 0, stage_time = 0; /* worker part, only for async loads. */
+		uint64_t load_start = 0, load_time = 0; /* context thread part. */
+		uint64_t wait_time = 0; /* from staged to loaded, waiting on dependencies or `update`. */
+		size_t disk_bytes = 0, gpu_bytes = 0;
+	};
+
 	struct res_provider_base {
+		std::string name; /* set by `res_manager::register_provider`. */
+
 		virtual ~res_provider_base() {}
 		virtual size_t get_size() const = 0;
+
+		/* storage slots for resource data, owned by the provider. */
+		virtual size_t allocate() = 0;
+		virtual void deallocate(size_t slot) = 0;
+		virtual std::byte *get_data(size_t slot) = 0;
+		virtual size_t get_count() const = 0; /* slots in use. */
+		virtual size_t get_capacity() const = 0; /* slots allocated in total. */
 		virtual void load(
 			res_manager &m,
 			const res_id_type &id,
@@ -335,6 +813,48 @@ namespace res {
 			const std::span<std::byte> &data
 		) = 0;
 		virtual void unload(res_manager &m, const res_id_type &id, const std::span<std::byte> &data) = 0;
+
+		/* load a loaded resource again in place. false if that failed and the
+		 * old version was kept, which only resources that can do so report. */
+		virtual bool reload(
+			res_manager &m,
+			const res_id_type &id,
+			const stdfs::path &path,
+			const std::span<std::byte> &data
+		) {
+			unload(m, id, data);
+			load(m, id, path, data);
+			return true;
+		}
+
+		/* true if the cpu part of loading can run on a worker thread (see `stage`). */
+		virtual bool is_stageable() const { return false; }
+
+		/* read and decode the resource file. called from a worker thread,
+		 * so it must not touch the resource manager or the gl context. */
+		virtual std::any stage(const stdfs::path &path) const { return {}; }
+
+		/* finish loading from the result of `stage`. called on the context thread. */
+		virtual void load_staged(
+			res_manager &m,
+			const res_id_type &id,
+			const stdfs::path &path,
+			const std::span<std::byte> &data,
+			std::any &&staged
+		) { load(m, id, path, data); }
+
+		/* memory used by a loaded resource, defaults to just its slot. */
+		virtual res_usage get_usage(const std::span<std::byte> &data) const {
+			return { get_size(), 0 };
+		}
+
+		/* called after the dependency `dep` of a loaded resource was reloaded in place. */
+		virtual void refresh_dependency(
+			res_manager &m,
+			const res_id_type &id,
+			const res_id_type &dep,
+			const std::span<std::byte> &data
+		) {}
 	};
 	
 
@@ -344,11 +864,57 @@ namespace res {
 		a.unload(mngr, id);
 	};
 
+	/* resource whose loading is split into a thread-safe `stage_from_file`
+	 * and a `load_from_staging` that does the rest on the context thread. */
+	template<typename T>
+	concept like_staged_resource_type = like_resource_type<T> && requires(
+		T a, const stdfs::path &path, const res_id_type &id, res_manager &mngr,
+		typename T::staging_type &&staging
+	) {
+		{ T::stage_from_file(path) } -> std::same_as<typename T::staging_type>;
+		a.load_from_staging(mngr, id, path, std::move(staging));
+	};
+
+	/* resource that can report how much memory it holds (see `res_usage`). */
+	template<typename T>
+	concept like_measured_resource_type = like_resource_type<T> && requires(const T a) {
+		{ a.get_usage() } -> std::same_as<res_usage>;
+	};
+
+	/* resource that can be loaded again in place and keeps its old version if
+	 * that fails, instead of failing the program (see `util::recoverable_failures`). */
+	template<typename T>
+	concept like_reloadable_resource_type = like_resource_type<T> && requires(
+		T a, const stdfs::path &path, const res_id_type &id, res_manager &mngr
+	) {
+		{ a.reload_from_file(mngr, id, path) } -> std::same_as<bool>;
+	};
+
+	/* resource that needs to react when one of its dependencies is reloaded. */
+	template<typename T>
+	concept like_refreshable_resource_type = like_resource_type<T> && requires(
+		T a, const res_id_type &id, res_manager &mngr
+	) {
+		a.refresh_dependency(mngr, id, id);
+	};
+
 	template<like_resource_type T>
 	struct res_provider : res_provider_base {
 		using res_type = T;
 		
 		size_t get_size() const override { return sizeof(T); }
+
+		size_t allocate() override { return pool_.allocate(); }
+		void deallocate(size_t slot) override { pool_.deallocate(slot); }
+		std::byte *get_data(size_t slot) override { return pool_.get(slot); }
+		size_t get_count() const override { return pool_.count(); }
+		size_t get_capacity() const override { return pool_.capacity(); }
+
+		/* call `f(T&)` for every loaded resource of this provider. slots are
+		 * allocated before their resource is constructed, so this must not be
+		 * called while a resource of this provider is being loaded. */
+		template<typename F>
+		void for_each(F &&f) { pool_.for_each(std::forward<F>(f)); }
 		
 		void load(
 			res_manager &m,
@@ -361,12 +927,72 @@ namespace res {
 			t->load_from_file(m, id, path);
 		}
 
+		bool is_stageable() const override { return like_staged_resource_type<T>; }
+
+		std::any stage(const stdfs::path &path) const override {
+			if constexpr(like_staged_resource_type<T>) return T::stage_from_file(path);
+			else return {};
+		}
+
+		void load_staged(
+			res_manager &m,
+			const res_id_type &id,
+			const stdfs::path &path,
+			const std::span<std::byte> &data,
+			std::any &&staged
+		) override {
+			if constexpr(like_staged_resource_type<T>) {
+				assert(data.size_bytes() >= sizeof(T));
+				T *t = new(data.data()) T;
+				t->load_from_staging(m, id, path, std::any_cast<typename T::staging_type>(std::move(staged)));
+			} else {
+				load(m, id, path, data);
+			}
+		}
+
+		res_usage get_usage(const std::span<std::byte> &data) const override {
+			if constexpr(like_measured_resource_type<T>) {
+				assert(data.size_bytes() >= sizeof(T));
+				return ((const T*)data.data())->get_usage();
+			} else {
+				return res_provider_base::get_usage(data);
+			}
+		}
+
+		bool reload(
+			res_manager &m,
+			const res_id_type &id,
+			const stdfs::path &path,
+			const std::span<std::byte> &data
+		) override {
+			if constexpr(like_reloadable_resource_type<T>) {
+				assert(data.size_bytes() >= sizeof(T));
+				return ((T*)data.data())->reload_from_file(m, id, path);
+			} else {
+				return res_provider_base::reload(m, id, path, data);
+			}
+		}
+
+		void refresh_dependency(
+			res_manager &m,
+			const res_id_type &id,
+			const res_id_type &dep,
+			const std::span<std::byte> &data
+		) override {
+			if constexpr(like_refreshable_resource_type<T>) {
+				assert(data.size_bytes() >= sizeof(T));
+				((T*)data.data())->refresh_dependency(m, id, dep);
+			}
+		}
+
 		void unload(res_manager &m, const res_id_type &id, const std::span<std::byte> &data) override {
 			assert(data.size_bytes() >= sizeof(T));
 			T *t = (T*)(data.data());
 			t->unload(m, id);
 			t->~T();
 		}
+	private:
+		::util::slot_pool<T> pool_;
 	};
 
 	class res_id_type {
@@ -410,13 +1036,44 @@ namespace res {
 		return os;
 	}
 
+	/* index of a resource slot in a res_manager together with the generation
+	 * of that slot. a handle is stale once its slot has been reused. */
+	struct res_handle {
+		static constexpr uint32_t invalid_index = UINT32_MAX;
+		uint32_t index = invalid_index;
+		uint32_t generation = 0;
+
+		bool is_valid() const { return index != invalid_index; }
+	};
+
 	class res_manager {
+		struct load_group_ {
+			size_t pending = 0; /* resources of the group still being loaded. */
+			std::function<void()> on_complete; /* called once pending drops to zero. */
+		};
 	public:
 		friend struct ref;
 
+		/* tracks an asynchronous load of a resource and all of its dependencies. */
+		class load_handle {
+			friend res_manager;
+			std::shared_ptr<load_group_> group_;
+			load_handle(std::shared_ptr<load_group_> group) : group_(std::move(group)) {}
+		public:
+			load_handle() {}
+
+			bool is_ready() const { return !group_ || group_->pending == 0; }
+
+			/* block until ready, finishing staged loads in the meantime. */
+			void wait(res_manager &m) const {
+				while(!is_ready()) m.wait_any_staged_();
+			}
+		};
+
 		template<like_resource_type T>
 		struct ref {
 			res_id_type id;
+			mutable res_handle handle; /* slot of `id`, resolved on first use. */
 
 			ref() {}
 
@@ -424,11 +1081,27 @@ namespace res {
 			ref(const res_id_type &id) : id(id) {}
 
 			void preload_from(res_manager &m) const {
-				m.resources_.find(id)->second.maybe_load(m, id);
+				m.resolve_(id, handle).maybe_load(m, id);
+			}
+
+			/* start loading in the background, see `res_manager::load_async`. */
+			load_handle preload_async(res_manager &m, std::function<void()> on_complete = {}) const {
+				return m.load_async(id, std::move(on_complete));
 			}
 
 			[[nodiscard]] T &get_from(res_manager &m) const {
-				return *(T*)m.resources_.find(id)->second.maybe_load(m, id);
+				return *(T*)m.resolve_(id, handle).maybe_load(m, id);
+			}
+
+			/* load and keep loaded (never evicted) until released, see `res_manager::acquire`. */
+			T &acquire_from(res_manager &m) const {
+				auto &container = m.resolve_(id, handle);
+				++container.refcount;
+				return *(T*)container.maybe_load(m, id);
+			}
+
+			void release_from(res_manager &m) const {
+				m.release_(m.resolve_(id, handle));
 			}
 
 			void context_from(res_manager &m, const auto &callable) {
@@ -440,7 +1113,7 @@ namespace res {
 
 
 		void new_resource(const res_id_type &id, const stdfs::path &path, strv provider) {
-			resources_.emplace(id, res_container(id, path, providers_[provider.data()].get()));
+			emplace_container_(id, path, providers_[provider.data()].get());
 		}
 
 		void new_resource(res_id_type &&id, const stdfs::path &path, strv provider) {
@@ -450,7 +1123,7 @@ namespace res {
 			clog.println("path: {}", path);
 			clog.println("provider: {}", provider);
 			clog.dedent();
-			resources_.emplace(std::move(id), res_container(id, path, providers_[provider.data()].get()));
+			emplace_container_(id, path, providers_[provider.data()].get());
 		}
 
 		res_id_type new_resource(const stdfs::path &path, strv provider) {
@@ -465,16 +1138,64 @@ namespace res {
 		}
 
 		void delete_resource(const res_id_type &id) {
-			resources_.find(id)->second.maybe_unload(*this, id);
+			get_container_(id).maybe_unload(*this, id);
 		}
 
 		void delete_resource(res_id_type &&id) {
-			resources_.find(std::move(id))->second.maybe_unload(*this, id);
+			get_container_(id).maybe_unload(*this, id);
+		}
+
+		/* unload a resource and forget about it. its slot gets reused, so
+		 * handles to it become stale. */
+		void remove_resource(const res_id_type &id) {
+			auto it = slot_by_id_.find(id);
+			if(it == slot_by_id_.end())
+				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
+			auto &slot = slots_[it->second];
+			auto &container = *slot.container;
+			container.maybe_unload(*this, id);
+			if(container.loaded || container.staging)
+				throw std::runtime_error("resource still in use: "s + container.to_string());
+			for(const auto &dep : container.deps)
+				if(auto *c = find_container_(dep)) c->rdeps.erase(id);
+			for(const auto &rdep : container.rdeps)
+				if(auto *c = find_container_(rdep)) c->deps.erase(id);
+			if(container.name.has_value()) names_.erase(*container.name);
+			slot.container.reset();
+			++slot.generation;
+			free_slots_.push_back(it->second);
+			slot_by_id_.erase(it);
 		}
 
 		template<typename T>
 		void delete_resource(/* const */ ref<T> &r) { delete_resource(r.id); }
 
+		/* load a resource and protect it from eviction until a matching `release`.
+		 * its dependencies are protected too, as long as it stays loaded. */
+		void acquire(const res_id_type &id) {
+			auto &container = get_container_(id);
+			++container.refcount;
+			container.maybe_load(*this, id);
+		}
+
+		void release(const res_id_type &id) {
+			release_(get_container_(id));
+		}
+
+		/* memory budget, unreferenced resources get evicted (least recently used
+		 * first) by `update` while the total usage exceeds it. */
+		void set_budget(const res_usage &budget) { budget_ = budget; }
+		const res_usage &get_budget() const { return budget_; }
+		const res_usage &get_usage() const { return usage_; }
+
+		/* current slot of a resource, throws if there is no such resource. */
+		res_handle get_handle(const res_id_type &id) const {
+			auto it = slot_by_id_.find(id);
+			if(it == slot_by_id_.end())
+				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
+			return { it->second, slots_[it->second].generation };
+		}
+
 		template<like_resource_type T>
 		ref<T> get_resource(const res_id_type &id) { return ref<T>(id); }
 
@@ -482,67 +1203,145 @@ namespace res {
 		ref<T> get_resource(res_id_type &&id) { return ref<T>(std::move(id)); }
 
 		template<like_resource_type T>
-		ref<T> get_resource(strv name) {
-			if(!names_.contains(name.data()))
-				throw std::runtime_error("no such resource: '"s + name.data() + "'");
-			return get_resource<T>(names_[name.data()]);
-		}
+		ref<T> get_resource(::util::string_id name) { return get_resource<T>(get_id_by_name(name)); }
+
+		template<like_resource_type T>
+		ref<T> get_resource(strv name) { return get_resource<T>(::util::string_id(name)); }
 
-		res_id_type get_id_by_name(strv name) const {
-			if(!names_.contains(name.data()))
-				throw std::runtime_error("no such resource: '"s + name.data() + "'");
-			return names_.find(name.data())->second;
+		res_id_type get_id_by_name(::util::string_id name) const {
+			auto it = names_.find(name);
+			if(it == names_.end())
+				throw std::runtime_error("no such resource: '"s + name.str() + "'");
+			return it->second;
 		}
 
+		res_id_type get_id_by_name(strv name) const { return get_id_by_name(::util::string_id(name)); }
+
 		void set_name(const res_id_type &id, strv name) {
-			if(!resources_.contains(id))
-				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
-			names_.emplace(name, id);
-			resources_.find(id)->second.name = name;
+			auto &container = get_container_(id);
+			auto sid = ::util::string_id::intern(name);
+			if(container.name.has_value()) names_.erase(*container.name);
+			names_.emplace(sid, id);
+			container.name = sid;
+		}
+
+		/* start loading a resource and its dependencies. the cpu part of loading
+		 * runs on the worker pool, the rest is done by `update` (or by `wait` on
+		 * the returned handle) on the context thread. resources whose provider is
+		 * not stageable are loaded synchronously.
+		 *
+		 * every dependency already known (from a previous load) is staged at once,
+		 * and a resource is only finished after its dependencies, so independent
+		 * resources load in parallel. dependencies found while loading join the
+		 * group as they are discovered. throws if the known dependencies contain
+		 * a cycle. `on_complete` is called on the context thread once the whole
+		 * group is loaded. */
+		load_handle load_async(const res_id_type &id, std::function<void()> on_complete = {}) {
+			auto order = sort_dependencies_(id);
+			auto group = std::make_shared<load_group_>();
+			group->on_complete = std::move(on_complete);
+			for(const auto &node : order)
+				begin_load_async_(node, group);
+			if(group->pending == 0 && group->on_complete) group->on_complete();
+			return load_handle(std::move(group));
+		}
+
+		/* watch the files of loaded resources and reload them in place when they
+		 * change (see `update`). refs stay valid across reloads. */
+		void enable_hot_reload() {
+			if(watcher_) return;
+			watcher_ = std::make_unique<::util::file_watcher>();
+			for(auto &slot : slots_) {
+				if(slot.container && slot.container->loaded)
+					watch_(*slot.container);
+			}
+		}
+
+		/* reload a loaded resource in place and refresh everything that depends on it. */
+		void reload_resource(const res_id_type &id) {
+			reload_batch_({ id });
+		}
+
+		/* finish all loads that have been staged so far, with hot reloading
+		 * enabled reload changed resources, and evict resources if over budget.
+		 * call once per frame. */
+		void update() {
+			++frame_;
+			if(watcher_) reload_changed_();
+			for(;;) {
+				staged_result_ result;
+				{
+					// take one at a time, finishing may wait on another staged result.
+					std::lock_guard lock(staged_mutex_);
+					if(staged_.empty()) break;
+					result = std::move(staged_.front());
+					staged_.pop_front();
+				}
+				finish_staged_(std::move(result));
+			}
+			evict_();
 		}
 
 		void delete_all() {
+			while(staging_count_ > 0) wait_any_staged_();
 			bool any_loaded;
 			do {
 				any_loaded = false;
-				for(auto &[id, container] : resources_) {
-					if(container.loaded) {
+				for(auto &slot : slots_) {
+					if(slot.container && slot.container->loaded) {
 						any_loaded = true;
-						container.maybe_unload(*this, id);
+						slot.container->maybe_unload(*this, slot.container->id);
 					}
 				}
 			} while(any_loaded);
 		}
 
 		void add_dependency(const res_id_type &id, const res_id_type &dep) {
-			if(!resources_.contains(id))
-				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
-			if(!resources_.contains(dep))
-				throw std::runtime_error("no such resource: '"s + dep.to_string() + "'");
-			auto &primary = resources_.find(id)->second;
-			auto &secondary = resources_.find(dep)->second;
+			auto &primary = get_container_(id);
+			auto &secondary = get_container_(dep);
 			primary.deps.insert(dep);
 			secondary.rdeps.insert(id);
 			clog.println("New dependency: {} on {}.", primary.to_string(), secondary.to_string());
 		}
 
 		void remove_dependency(const res_id_type &id, const res_id_type &dep) {
-			if(!resources_.contains(id))
-				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
-			resources_.find(id)->second.deps.erase(dep);
-			if(!resources_.contains(dep))
-				throw std::runtime_error("no such resource: '"s + dep.to_string() + "'");
-			resources_.find(dep)->second.rdeps.erase(id);
+			get_container_(id).deps.erase(dep);
+			get_container_(dep).rdeps.erase(id);
 		}
 
 		template<typename T, typename Provider = res_provider<T>, typename ...Args>
 		void register_provider(strv name, Args &&...args) {
 			providers_[name.data()] = std::unique_ptr<res_provider_base>(new Provider(args...));
+			providers_[name.data()]->name = name;
 		}
 
 		void unregister_provider(strv name) { providers_.erase(name.data()); }
 
+		/* provider registered under `name`, null if there is none or if it is not a res_provider<T>. */
+		template<like_resource_type T>
+		res_provider<T> *get_provider(strv name) {
+			auto it = providers_.find(name.data());
+			if(it == providers_.end()) return nullptr;
+			return dynamic_cast<res_provider<T>*>(it->second.get());
+		}
+
+		void print_provider_stats() {
+			clog.println("Providers:");
+			clog.indent();
+			for(const auto &[name, provider] : providers_) {
+				clog.println("{}: {}/{} slots ({} bytes each)", name,
+					provider->get_count(), provider->get_capacity(), provider->get_size());
+			}
+			clog.dedent();
+			clog.println("Usage: {} cpu bytes, {} gpu bytes.", usage_.cpu_bytes, usage_.gpu_bytes);
+		}
+
+		/* load a json manifest, or a binary one (see `load_from_binary`) if the extension is .bin. */
 		void load_from_file(const stdfs::path &path) {
+			if(path.extension() == ".bin") {
+				load_from_binary(path);
+				return;
+			}
 			auto res = ::util::json::read_file(path);
 			::util::json::assert_type(res, ::util::json::value_kind::object);
 			::util::json::assert_contains(res, "resources");
@@ -577,63 +1376,480 @@ namespace res {
 			}
 		}
 
-		res_manager() : generator_(rand_engine_) {}
-	private:
-		static std::mt19937 rand_engine_;
-		uuids::uuid_random_generator generator_;
+		/* load a manifest compiled from json by resman_gen.py. the file is
+		 * mapped and registered in place, without any parsing or per-entry logging. */
+		void load_from_binary(const stdfs::path &path) {
+			::util::mapped_file file(path);
+			auto bytes = file.bytes();
+			if(bytes.size() < sizeof(binary_header_))
+				::util::fail_error("Truncated manifest: {}", path);
+			const auto *header = (const binary_header_*)bytes.data();
+			if(std::memcmp(header->magic, binary_magic_, sizeof(header->magic)) != 0)
+				::util::fail_error("Not a binary manifest: {}", path);
+			if(header->version != binary_version_)
+				::util::fail_error("Unsupported manifest version: {}.", header->version);
+
+			size_t providers_offset = sizeof(binary_header_);
+			size_t entries_offset = providers_offset + header->provider_count * sizeof(binary_string_);
+			size_t strings_offset = entries_offset + header->entry_count * sizeof(binary_entry_);
+			if(strings_offset + header->strings_size > bytes.size())
+				::util::fail_error("Truncated manifest: {}", path);
+
+			const auto *provider_names = (const binary_string_*)(bytes.data() + providers_offset);
+			const auto *entries = (const binary_entry_*)(bytes.data() + entries_offset);
+			const char *strings = (const char*)(bytes.data() + strings_offset);
+			auto get_string = [&](const binary_string_ &s) -> strv {
+				if(s.offset > header->strings_size || s.length > header->strings_size - s.offset)
+					::util::fail_error("Bad string in manifest: {}", path);
+				return strv(strings + s.offset, s.length);
+			};
+
+			std::vector<res_provider_base*> providers(header->provider_count);
+			for(size_t i = 0; i < providers.size(); ++i) {
+				auto name = std::string(get_string(provider_names[i]));
+				if(!providers_.contains(name))
+					::util::fail_error("Unknown provider: '{}'.", name);
+				providers[i] = providers_[name].get();
+			}
 
-		struct res_container {
-			res_id_type id; /* resource id. */
-			stdfs::path path; /* path to resource. */
-			std::optional<std::string> name; /* resource name. */
-			res_provider_base *provider; /* resource provider. */
-			using set_cmp_ = decltype([](const res_id_type &a, const res_id_type &b) -> bool {
-				return res_id_type::hash{}(a) < res_id_type::hash{}(b);
-			});
+			slot_by_id_.reserve(slot_by_id_.size() + header->entry_count);
+			for(size_t i = 0; i < header->entry_count; ++i) {
+				const auto &entry = entries[i];
+				// sorted and unique, so every entry must be greater than the previous one.
+				if(i > 0 && std::memcmp(entries[i - 1].uuid, entry.uuid, sizeof(entry.uuid)) >= 0)
+					::util::fail_error("Manifest entries not sorted: {}", path);
+				if(entry.provider >= providers.size())
+					::util::fail_error("Bad provider index in manifest: {}", path);
+				res_id_type id = uuids::uuid(std::begin(entry.uuid), std::end(entry.uuid));
+				emplace_container_(id, get_string(entry.path), providers[entry.provider]);
+				if(entry.name.offset != binary_no_name_)
+					set_name(id, get_string(entry.name));
+			}
+			clog.println("Loaded {} resources from {}.", header->entry_count, path);
+		}
+
+		/* every load so far, in the order they finished. */
+		const std::vector<load_record> &get_load_records() const { return records_; }
+
+		/* write all load records as a chrome trace (chrome://tracing, perfetto). */
+		void write_load_trace(const stdfs::path &path) const {
+			auto events = nmann::json::array();
+			for(size_t i = 0; i < records_.size(); ++i) {
+				const auto &r = records_[i];
+				nmann::json args = {
+					{ "disk_bytes", r.disk_bytes },
+					{ "gpu_bytes", r.gpu_bytes },
+					{ "wait_us", r.wait_time },
+				};
+				if(r.async) {
+					events.push_back({ { "name", "stage " + r.resource }, { "cat", r.provider }, { "ph", "X" },
+						{ "ts", r.stage_start }, { "dur", r.stage_time }, { "pid", 1 }, { "tid", r.stage_thread }, { "args", args } });
+					// waits overlap freely, so use async events for them.
+					uint64_t staged = r.stage_start + r.stage_time;
+					events.push_back({ { "name", "wait " + r.resource }, { "cat", r.provider }, { "ph", "b" },
+						{ "id", i }, { "ts", staged }, { "pid", 1 }, { "tid", r.load_thread } });
+					events.push_back({ { "name", "wait " + r.resource }, { "cat", r.provider }, { "ph", "e" },
+						{ "id", i }, { "ts", staged + r.wait_time }, { "pid", 1 }, { "tid", r.load_thread } });
+				}
+				events.push_back({ { "name", "load " + r.resource }, { "cat", r.provider }, { "ph", "X" },
+					{ "ts", r.load_start }, { "dur", r.load_time }, { "pid", 1 }, { "tid", r.load_thread }, { "args", args } });
+			}
+			std::ofstream out(path);
+			out.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+			out << nmann::json { { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+		}
+
+		/* totals of all load records, per provider. */
+		void print_load_summary() const {
+			struct totals { size_t count = 0; uint64_t stage = 0, load = 0, wait = 0; size_t disk = 0, gpu = 0; };
+			std::map<std::string, totals> per_provider;
+			for(const auto &r : records_) {
+				auto &t = per_provider[r.provider];
+				++t.count;
+				t.stage += r.stage_time;
+				t.load += r.load_time;
+				t.wait += r.wait_time;
+				t.disk += r.disk_bytes;
+				t.gpu += r.gpu_bytes;
+			}
+			clog.println("Loads:");
+			clog.indent();
+			clog.println("{:<10} {:>6} {:>10} {:>10} {:>10} {:>12} {:>12}",
+				"provider", "count", "stage ms", "load ms", "wait ms", "disk bytes", "gpu bytes");
+			for(const auto &[name, t] : per_provider) {
+				clog.println("{:<10} {:>6} {:>10.2f} {:>10.2f} {:>10.2f} {:>12} {:>12}",
+					name, t.count, t.stage / 1000.0, t.load / 1000.0, t.wait / 1000.0, t.disk, t.gpu);
+			}
+			clog.dedent();
+		}
+
+		res_manager() : generator_(rand_engine_), epoch_(stdch::steady_clock::now()) {
+			::util::thread_index(); // make sure the context thread is thread 0.
+		}
+	private:
+		/* on-disk layout of binary manifests, see resman_gen.py. assumes a little-endian host. */
+		static constexpr char binary_magic_[4] = { 'G', 'R', 'M', '1' };
+		static constexpr uint32_t binary_version_ = 1;
+		static constexpr uint32_t binary_no_name_ = UINT32_MAX;
+
+		struct binary_header_ {
+			char magic[4];
+			uint32_t version;
+			uint32_t provider_count;
+			uint32_t entry_count;
+			uint32_t strings_size;
+		};
+
+		struct binary_string_ {
+			uint32_t offset, length;
+		};
+
+		struct binary_entry_ {
+			uint8_t uuid[16];
+			uint32_t provider;
+			binary_string_ path;
+			binary_string_ name;
+		};
+
+		static_assert(sizeof(binary_header_) == 20);
+		static_assert(sizeof(binary_entry_) == 36);
+
+		static std::mt19937 rand_engine_;
+		uuids::uuid_random_generator generator_;
+
+		struct res_container;
+
+		struct staged_result_ {
+			res_id_type id;
+			std::any staged;
+			load_record record; /* with the worker part filled in. */
+			std::optional<std::string> error; /* why staging failed, see `finish_now_`. */
+		};
+
+		/* microseconds since the manager was created, safe to call from workers. */
+		uint64_t now_() const {
+			return stdch::duration_cast<stdch::microseconds>(stdch::steady_clock::now() - epoch_).count();
+		}
+
+		/* known dependencies of `id` (and `id` itself) in an order where
+		 * every resource comes after its dependencies. */
+		std::vector<res_id_type> sort_dependencies_(const res_id_type &id) {
+			enum class mark { visiting, done };
+			std::unordered_map<res_id_type, mark, res_id_type::hash> marks;
+			std::vector<res_id_type> order;
+			std::vector<res_id_type> path; /* for reporting cycles. */
+			auto visit = [&](const auto &visit, const res_id_type &node) -> void {
+				if(auto it = marks.find(node); it != marks.end()) {
+					if(it->second == mark::done) return;
+					std::string cycle;
+					auto from = std::find(path.begin(), path.end(), node);
+					for(auto p = from; p != path.end(); ++p)
+						cycle += get_container_(*p).to_string() + " -> ";
+					throw std::runtime_error("dependency cycle: " + cycle + get_container_(node).to_string());
+				}
+				marks.emplace(node, mark::visiting);
+				path.push_back(node);
+				for(const auto &dep : get_container_(node).deps)
+					visit(visit, dep);
+				path.pop_back();
+				marks[node] = mark::done;
+				order.push_back(node);
+			};
+			visit(visit, id);
+			return order;
+		}
+
+		void complete_one_(load_group_ &group) {
+			if(--group.pending == 0 && group.on_complete) group.on_complete();
+		}
+
+		void begin_load_async_(const res_id_type &id, const std::shared_ptr<load_group_> &group) {
+			auto &container = get_container_(id);
+			if(container.loaded) return;
+			if(container.staging) {
+				auto &waiters = container.waiters;
+				if(std::find(waiters.begin(), waiters.end(), group) == waiters.end()) {
+					++group->pending;
+					waiters.push_back(group);
+				}
+				return;
+			}
+			if(!container.provider->is_stageable()) {
+				container.maybe_load(*this, id);
+				return;
+			}
+			clog.println("Staging {}.", container.to_string());
+			container.staging = true;
+			++staging_count_;
+			++group->pending;
+			container.waiters.push_back(group);
+			pool_.submit([this, id, path = container.path, provider = container.provider] {
+				load_record record;
+				record.async = true;
+				record.stage_thread = ::util::thread_index();
+				record.stage_start = now_();
+				size_t bytes_read = ::util::bytes_read;
+				// failing here would exit or terminate while the context thread
+				// is running, so failures are handed to it instead.
+				std::any staged;
+				std::optional<std::string> error;
+				try {
+					::util::recoverable_failures recoverable;
+					staged = provider->stage(path);
+				} catch(const ::util::failure &) {
+					error = "see the error above";
+				} catch(const std::exception &e) {
+					error = e.what();
+				}
+				record.stage_time = now_() - record.stage_start;
+				record.disk_bytes = ::util::bytes_read - bytes_read;
+				{
+					std::lock_guard lock(staged_mutex_);
+					staged_.push_back({ id, std::move(staged), std::move(record), std::move(error) });
+				}
+				staged_cv_.notify_all();
+			});
+		}
+
+		void finish_staged_(staged_result_ &&result) {
+			auto &container = get_container_(result.id);
+			finish_or_park_(container, std::move(result));
+		}
+
+		/* finish a staged resource if all of its known dependencies are loaded,
+		 * otherwise park the result until the last of them is finished. */
+		void finish_or_park_(res_container &container, staged_result_ &&staged) {
+			bool ready = true;
+			for(const auto &dep : container.deps) {
+				auto *c = find_container_(dep);
+				if(c == nullptr || c->loaded) continue;
+				if(!c->staging) { // e.g. evicted in the meantime.
+					// without waiters nobody else would restart it.
+					if(container.waiters.empty()) begin_load_async_(dep, std::make_shared<load_group_>());
+					for(const auto &group : container.waiters)
+						begin_load_async_(dep, group);
+				}
+				// resources that can't be staged were just loaded synchronously.
+				if(!c->loaded) ready = false;
+			}
+			if(!ready) {
+				container.parked = std::move(staged);
+				return;
+			}
+			finish_now_(container, std::move(staged));
+		}
+
+		/* upload a staged resource, continue with newly found dependencies and
+		 * then with parked dependents that were waiting on it. */
+		void finish_now_(res_container &container, staged_result_ &&staged) {
+			if(staged.error) {
+				// let the waiting loads end before failing, in case that is recovered from.
+				container.staging = false;
+				--staging_count_;
+				auto waiters = std::move(container.waiters);
+				container.waiters.clear();
+				for(const auto &group : waiters)
+					complete_one_(*group);
+				::util::fail_error("Failed to stage {}: {}", container.to_string(), *staged.error);
+				return;
+			}
+			auto &record = staged.record;
+			record.load_thread = ::util::thread_index();
+			record.load_start = now_();
+			record.wait_time = record.load_start - (record.stage_start + record.stage_time);
+			size_t bytes_read = ::util::bytes_read;
+			container.finish_staged(*this, container.id, std::move(staged.staged));
+			record.load_time = now_() - record.load_start;
+			record.disk_bytes += ::util::bytes_read - bytes_read;
+			add_record_(container, std::move(record));
+			--staging_count_;
+			auto waiters = std::move(container.waiters);
+			container.waiters.clear();
+			for(const auto &group : waiters) {
+				for(const auto &dep : container.deps)
+					begin_load_async_(dep, group);
+				complete_one_(*group);
+			}
+			for(const auto &rdep : container.rdeps) {
+				auto *c = find_container_(rdep);
+				if(c == nullptr || !c->parked.has_value()) continue;
+				auto parked = std::move(*c->parked);
+				c->parked.reset();
+				finish_or_park_(*c, std::move(parked));
+			}
+		}
+
+		/* block until at least one staged load is available, then finish all of them. */
+		void wait_any_staged_() {
+			{
+				std::unique_lock lock(staged_mutex_);
+				staged_cv_.wait(lock, [this] { return !staged_.empty(); });
+			}
+			update();
+		}
+
+		/* block until the staging of `id` is done and take its result, leaving
+		 * the finishing to the caller. */
+		staged_result_ take_staged_(const res_id_type &id) {
+			staged_result_ result;
+			{
+				std::unique_lock lock(staged_mutex_);
+				decltype(staged_)::iterator it;
+				staged_cv_.wait(lock, [&] {
+					it = std::find_if(staged_.begin(), staged_.end(),
+						[&](const staged_result_ &r) { return r.id == id; });
+					return it != staged_.end();
+				});
+				result = std::move(*it);
+				staged_.erase(it);
+			}
+			return result;
+		}
+
+		struct res_container {
+			res_id_type id; /* resource id. */
+			stdfs::path path; /* path to resource. */
+			std::optional<::util::string_id> name; /* resource name. */
+			res_provider_base *provider; /* resource provider. */
+			using set_cmp_ = decltype([](const res_id_type &a, const res_id_type &b) -> bool {
+				return res_id_type::hash{}(a) < res_id_type::hash{}(b);
+			});
 			std::set<res_id_type, set_cmp_> deps; /* dependencies. */
 			std::set<res_id_type, set_cmp_> rdeps; /* reverse dependencies. */
 
 			std::byte *data; /* resource data as an opaque pointer. */
+			size_t slot; /* provider slot holding `data`. */
 			bool loaded = false; /* true if resource has been loaded, false otherwise. */
+			bool staging = false; /* true while a worker is staging the resource. */
+			uint32_t refcount = 0; /* acquisitions, never evicted while non-zero. */
+			uint64_t last_used = 0; /* `res_manager::frame_` of the last access. */
+			res_usage usage; /* memory used while loaded. */
+			std::vector<std::shared_ptr<load_group_>> waiters; /* async loads waiting on staging. */
+			std::optional<staged_result_> parked; /* staged, but waiting for dependencies to finish. */
 
 			res_container(
 				res_id_type id,
 				const stdfs::path &path,
 				res_provider_base *provider
 			) : id(id), path(path), provider(provider),
-			    data(nullptr), loaded(false) {}
+			    data(nullptr), slot(0), loaded(false) {}
 
 			/* load the resource if it hasn't been loaded yet. will also load dependencies. */
 			void *maybe_load(res_manager &m, const res_id_type &id) {
+				last_used = m.frame_;
 				if(loaded) return data;
+				if(staging) {
+					// already being loaded asynchronously, finish that load now. the
+					// dependencies go first, parking would leave this unloaded.
+					staged_result_ staged;
+					if(parked.has_value()) {
+						staged = std::move(*parked);
+						parked.reset();
+					} else {
+						staged = m.take_staged_(id);
+					}
+					for(const auto &dep : deps)
+						if(auto *c = m.find_container_(dep)) c->maybe_load(m, dep);
+					m.finish_now_(*this, std::move(staged));
+					assert(loaded);
+					return data;
+				}
 				clog.println("Trying to load {}.", to_string());
 				clog.indent();
-				data = new std::byte[provider->get_size()];
+				slot = provider->allocate();
+				data = provider->get_data(slot);
 				clog.println("Loading...");
 				clog.indent();
+				load_record record;
+				record.load_thread = ::util::thread_index();
+				record.load_start = m.now_();
+				size_t bytes_read = ::util::bytes_read;
 				provider->load(m, id, path, std::span<std::byte>(data, provider->get_size()));
+				record.load_time = m.now_() - record.load_start;
+				record.disk_bytes = ::util::bytes_read - bytes_read;
 				clog.dedent();
 				for(const auto &dep : deps) {
 					clog.println("Dependency: {}.", dep.to_string());
-					if(auto it = m.resources_.find(dep); it != m.resources_.end()) {
+					if(auto *c = m.find_container_(dep)) {
 						clog.indent();
-						it->second.maybe_load(m, it->first);
+						c->maybe_load(m, dep);
 						clog.dedent();
 					}
 				}
 				loaded = true;
+				update_usage(m);
+				m.add_record_(*this, std::move(record));
+				m.watch_(*this);
 				clog.dedent();
 				return data;
 			}
 
+			/* finish an asynchronous load on the context thread. dependencies are left to the caller. */
+			void finish_staged(res_manager &m, const res_id_type &id, std::any &&staged) {
+				clog.println("Loading staged {}.", to_string());
+				clog.indent();
+				slot = provider->allocate();
+				data = provider->get_data(slot);
+				provider->load_staged(m, id, path, std::span<std::byte>(data, provider->get_size()), std::move(staged));
+				clog.dedent();
+				staging = false;
+				loaded = true;
+				last_used = m.frame_;
+				update_usage(m);
+				m.watch_(*this);
+			}
+
+			/* load again into the same slot, so that `data` stays where it is.
+			 * false if the resource failed to load and kept its old version. */
+			bool reload(res_manager &m, const res_id_type &id) {
+				if(!loaded) return false;
+				clog.println("Reloading {}.", to_string());
+				clog.indent();
+				auto span = std::span<std::byte>(data, provider->get_size());
+				// the new version adds its dependencies again while loading.
+				auto old_deps = std::move(deps);
+				deps.clear();
+				for(const auto &dep : old_deps)
+					if(auto *c = m.find_container_(dep)) c->rdeps.erase(id);
+				bool reloaded = provider->reload(m, id, path, span);
+				if(!reloaded) {
+					for(const auto &dep : deps)
+						if(auto *c = m.find_container_(dep)) c->rdeps.erase(id);
+					deps = std::move(old_deps);
+					for(const auto &dep : deps)
+						if(auto *c = m.find_container_(dep)) c->rdeps.insert(id);
+					clog.println("Kept the old version.");
+				}
+				for(const auto &dep : deps)
+					if(auto *c = m.find_container_(dep)) c->maybe_load(m, dep);
+				update_usage(m);
+				clog.dedent();
+				return reloaded;
+			}
+
+			/* re-measure the loaded resource and update the manager's total. */
+			void update_usage(res_manager &m) {
+				m.usage_ -= usage;
+				usage = provider->get_usage(std::span<std::byte>(data, provider->get_size()));
+				m.usage_ += usage;
+			}
+
+			bool has_loaded_rdeps(res_manager &m) const {
+				for(const auto &dep : rdeps) {
+					if(auto *c = m.find_container_(dep); c != nullptr && c->loaded)
+						return true;
+				}
+				return false;
+			}
+
 			/* unload the resource if it hasn't been unloaded yet and no reverse dependencies are loaded. */
 			void maybe_unload(res_manager &m, const res_id_type &id) {
 				if(!loaded) return;
 				clog.println("Trying to unload {}.", to_string());
 				clog.indent();
 				for(const auto &dep : rdeps) {
-					if(auto it = m.resources_.find(dep); it != m.resources_.end()) {
-						if(it->second.loaded) {
+					if(auto *c = m.find_container_(dep)) {
+						if(c->loaded) {
 							clog.println("Will not unload due to rev. dependencies.");
 							clog.dedent();
 							return; // do not unload, reverse dependency still loaded.
@@ -644,13 +1860,16 @@ namespace res {
 				clog.indent();
 				provider->unload(m, id, std::span<std::byte>(data, provider->get_size()));
 				clog.dedent();
-				delete data;
+				provider->deallocate(slot);
+				data = nullptr;
 				loaded = false;
+				m.usage_ -= usage;
+				usage = {};
 				clog.dedent();
 			}
 
 			std::string to_string() const {
-				if(name.has_value()) return "'" + name.value() + "'";
+				if(name.has_value()) return "'" + name->str() + "'";
 				return "{" + id.to_string() + "}";
 			}
 
@@ -661,9 +1880,175 @@ namespace res {
 			}
 		};
 
-		std::unordered_map<std::string, res_id_type> names_;
+		std::unordered_map<::util::string_id, res_id_type, ::util::string_id::hash> names_;
 		std::unordered_map<std::string, std::unique_ptr<res_provider_base>> providers_;
-		std::unordered_map<res_id_type, res_container, res_id_type::hash> resources_;
+
+		struct res_slot_ {
+			uint32_t generation = 0; /* bumped every time the slot is freed. */
+			std::optional<res_container> container; /* empty if the slot is free. */
+		};
+
+		void emplace_container_(const res_id_type &id, const stdfs::path &path, res_provider_base *provider) {
+			if(slot_by_id_.contains(id)) return;
+			uint32_t index;
+			if(!free_slots_.empty()) {
+				index = free_slots_.back();
+				free_slots_.pop_back();
+			} else {
+				index = slots_.size();
+				slots_.emplace_back();
+			}
+			slots_[index].container.emplace(id, path, provider);
+			slot_by_id_.emplace(id, index);
+		}
+
+		res_container *find_container_(const res_id_type &id) {
+			auto it = slot_by_id_.find(id);
+			if(it == slot_by_id_.end()) return nullptr;
+			return &*slots_[it->second].container;
+		}
+
+		res_container &get_container_(const res_id_type &id) {
+			auto *container = find_container_(id);
+			if(container == nullptr)
+				throw std::runtime_error("no such resource: '"s + id.to_string() + "'");
+			return *container;
+		}
+
+		/* container of `id` through a cached handle. only hashes the id
+		 * (and updates the handle) if the handle is stale or was never resolved.
+		 * the id compare catches refs whose `id` has been reassigned. */
+		res_container &resolve_(const res_id_type &id, res_handle &handle) {
+			if(handle.index < slots_.size()) {
+				auto &slot = slots_[handle.index];
+				if(slot.generation == handle.generation && slot.container && slot.container->id == id)
+					return *slot.container;
+			}
+			handle = get_handle(id);
+			return *slots_[handle.index].container;
+		}
+
+		/* start watching the file (or directory) of a container, if hot reloading is enabled. */
+		void watch_(const res_container &container) {
+			if(!watcher_) return;
+			auto key = container.path.lexically_normal();
+			auto &ids = watched_[key.string()];
+			if(std::find(ids.begin(), ids.end(), container.id) != ids.end()) return;
+			ids.push_back(container.id);
+			if(stdfs::is_directory(key)) watcher_->watch_directory(key);
+			else watcher_->watch_directory(key.has_parent_path() ? key.parent_path() : ".");
+		}
+
+		/* reload everything that changed since the last call as one batch. */
+		void reload_changed_() {
+			std::vector<res_id_type> changed;
+			for(const auto &path : watcher_->poll()) {
+				// a resource path is either the changed file or its directory (e.g. shaders).
+				for(const auto &key : { path, path.parent_path() }) {
+					auto it = watched_.find(key.string());
+					if(it == watched_.end()) continue;
+					for(const auto &id : it->second) {
+						if(std::find(changed.begin(), changed.end(), id) == changed.end())
+							changed.push_back(id);
+					}
+				}
+			}
+			if(!changed.empty()) reload_batch_(changed);
+		}
+
+		/* reload each resource once, then refresh all (transitive) dependents once. */
+		void reload_batch_(const std::vector<res_id_type> &ids) {
+			std::vector<res_id_type> refreshed;
+			std::vector<res_id_type> stack;
+			for(const auto &id : ids) {
+				auto *container = find_container_(id);
+				if(container == nullptr || !container->loaded) continue;
+				if(container->reload(*this, id)) stack.push_back(id);
+			}
+			while(!stack.empty()) {
+				auto id = stack.back();
+				stack.pop_back();
+				auto *container = find_container_(id);
+				if(container == nullptr) continue;
+				for(const auto &rdep : container->rdeps) {
+					if(std::find(refreshed.begin(), refreshed.end(), rdep) != refreshed.end()) continue;
+					refreshed.push_back(rdep);
+					auto *dependent = find_container_(rdep);
+					if(dependent == nullptr || !dependent->loaded) continue;
+					clog.println("Refreshing {}.", dependent->to_string());
+					dependent->provider->refresh_dependency(*this, rdep, id,
+						std::span<std::byte>(dependent->data, dependent->provider->get_size()));
+					stack.push_back(rdep);
+				}
+			}
+		}
+
+		void add_record_(const res_container &container, load_record &&record) {
+			record.resource = container.to_string();
+			record.provider = container.provider->name;
+			record.gpu_bytes = container.usage.gpu_bytes;
+			records_.push_back(std::move(record));
+		}
+
+		void release_(res_container &container) {
+			assert(container.refcount > 0 && "release without acquire");
+			--container.refcount;
+		}
+
+		bool over_budget_() const {
+			return usage_.cpu_bytes > budget_.cpu_bytes || usage_.gpu_bytes > budget_.gpu_bytes;
+		}
+
+		/* unload unreferenced resources, least recently used first, until within budget.
+		 * resources used since the previous update (`update` has already counted the
+		 * new frame, so that is `frame_ - 1`) and those with loaded reverse dependencies
+		 * are kept; evicting a dependent can free its dependencies in a later pass. */
+		void evict_() {
+			if(!over_budget_()) return;
+			std::vector<res_container*> candidates;
+			for(auto &slot : slots_) {
+				auto &c = slot.container;
+				if(c && c->loaded && !c->staging && c->refcount == 0 && c->last_used + 1 < frame_)
+					candidates.push_back(&*c);
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const auto *a, const auto *b) {
+				return a->last_used < b->last_used;
+			});
+			bool progress = true;
+			while(progress && over_budget_()) {
+				progress = false;
+				for(auto *&c : candidates) {
+					if(c == nullptr || c->has_loaded_rdeps(*this)) continue;
+					clog.println("Evicting {}.", c->to_string());
+					clog.indent();
+					c->maybe_unload(*this, c->id);
+					clog.dedent();
+					c = nullptr;
+					progress = true;
+					if(!over_budget_()) break;
+				}
+			}
+		}
+
+		stdch::steady_clock::time_point epoch_;
+		std::vector<load_record> records_;
+
+		uint64_t frame_ = 0; /* number of `update` calls. */
+		res_usage usage_; /* total of all loaded resources. */
+		res_usage budget_ { SIZE_MAX, SIZE_MAX };
+
+		std::unique_ptr<::util::file_watcher> watcher_; /* null unless hot reloading is enabled. */
+		std::unordered_map<std::string, std::vector<res_id_type>> watched_; /* path to resources. */
+
+		std::deque<res_slot_> slots_; /* deque, so that containers never move. */
+		std::vector<uint32_t> free_slots_;
+		std::unordered_map<res_id_type, uint32_t, res_id_type::hash> slot_by_id_;
+
+		std::mutex staged_mutex_;
+		std::condition_variable staged_cv_;
+		std::deque<staged_result_> staged_; /* staged by workers, waiting for `update`. */
+		size_t staging_count_ = 0; /* resources currently staging. */
+		::util::thread_pool pool_; /* declared last so that it is joined first. */
 	};
 
 	std::mt19937 res_manager::rand_engine_{};
@@ -699,279 +2084,2733 @@ namespace util::json {
 
 namespace gfx {
 	class renderer;
-	
-	class shader {
-		friend ::gfx::renderer;
-		GLuint id;
-	public:
-		void unload(::res::res_manager &m, const ::res::res_id_type &rid) {
-			glDeleteProgram(id);
+
+	/* gpu-ready binary assets written by the cooker (the GAEM_COOKER build,
+	 * see build.cfg) to `root`, mirroring the paths of their sources.
+	 * the data is stored in the exact layout it is uploaded in. */
+	namespace cooked {
+		constexpr const char *root = "build/cooked";
+		constexpr char mesh_magic[4] = { 'G', 'M', 'S', 'H' };
+		constexpr char texture_magic[4] = { 'G', 'T', 'E', 'X' };
+		constexpr uint32_t version = 6;
+
+		/* followed by the submeshes (gfx::mesh::submesh), the lods (gfx::mesh::lod_level),
+		 * the meshlets (gfx::cluster::meshlet), the vertex data and then the index data. */
+		struct mesh_header {
+			char magic[4];
+			uint32_t version;
+			uint32_t mode; /* gfx::mesh_mode. */
+			uint32_t indexed;
+			uint32_t vertex_count, vertex_size;
+			uint32_t index_count, index_size;
+			uint32_t submesh_count, lod_count, meshlet_count;
+			uint32_t vertex_format; /* gfx::vertex_format::to_bits. */
+			float position_scale[3], position_offset[3];
+			float bounding_sphere[4]; /* gfx::sphere. */
+			float bounding_box[6]; /* gfx::aabb. */
+		};
+
+		/* followed by the mip chain, level 0 first, each level tightly packed. */
+		struct texture_header {
+			char magic[4];
+			uint32_t version;
+			uint32_t width, height;
+			uint32_t levels;
+			uint32_t internal_format, format, type; /* gl enums. */
+		};
+
+		bool has_magic(const stdfs::path &path, const char (&magic)[4]) {
+			char buffer[4] {};
+			std::ifstream inp(path, std::ios::binary);
+			inp.read(buffer, sizeof(buffer));
+			return inp && std::memcmp(buffer, magic, sizeof(buffer)) == 0;
 		}
 
-		void load_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &general_path) {
-			stdfs::path vs_path = general_path / "vert.glsl";
-			stdfs::path fs_path = general_path / "frag.glsl";
-			clog.println("path: {}", general_path);
-			clog.println("vs path: {}", vs_path);
-			clog.println("fs path: {}", fs_path);
+		/* the cooked version of `source`: `source` itself if it already is cooked,
+		 * or its counterpart under `root` if that is not older than `source`.
+		 * empty if there is none. */
+		stdfs::path find(const stdfs::path &source, const char (&magic)[4]) {
+			if(has_magic(source, magic)) return source;
+			auto path = root / source.relative_path();
+			std::error_code ec;
+			auto cooked_time = stdfs::last_write_time(path, ec);
+			if(ec) return {};
+			auto source_time = stdfs::last_write_time(source, ec);
+			if(ec || cooked_time < source_time || !has_magic(path, magic)) return {};
+			return path;
+		}
 
-			auto vs = glCreateShader(GL_VERTEX_SHADER);
-			auto vs_content = ::util::read_file(vs_path);
-			vs_content.push_back('\0');
-			const char *vs_content_data = vs_content.data();
-			glShaderSource(vs, 1, &vs_content_data, nullptr);
-			glCompileShader(vs);
+		void write(const stdfs::path &path, const std::vector<std::span<const std::byte>> &parts) {
+			if(path.has_parent_path()) stdfs::create_directories(path.parent_path());
+			std::ofstream out(path, std::ios::binary);
+			out.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+			for(const auto &part : parts)
+				out.write((const char*)part.data(), part.size());
+		}
+	}
 
-			GLint success = GL_FALSE;
-			glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-			if(!success) {
-				GLchar message[1024];
-				glGetShaderInfoLog(vs, 1024, nullptr, message);
-				::util::fail_error("Failed to compile vertex shader:\n{}", message);
-			}
+	/* wavefront .obj parser, geometry only (v, vt, vn and f, the rest is skipped).
+	 * the file is mapped and split into line-aligned chunks which are parsed in
+	 * parallel and then concatenated. */
+	namespace obj {
+		/* 0-based, -1 when the vertex has no such attribute. */
+		struct index {
+			int32_t pos, texcoord, norm;
+		};
 
-			auto fs = glCreateShader(GL_FRAGMENT_SHADER);
-			auto fs_content = ::util::read_file(fs_path);
-			fs_content.push_back('\0');
-			const char *fs_content_data = fs_content.data();
-			glShaderSource(fs, 1, &fs_content_data, nullptr);
-			glCompileShader(fs);
+		/* the equivalent of tinyobj::attrib_t, with all faces fanned into triangles. */
+		struct data {
+			std::vector<float> positions; /* xyz. */
+			std::vector<float> texcoords; /* uv. */
+			std::vector<float> normals; /* xyz. */
+			std::vector<index> indices;
+		};
 
-			glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
-			if(!success) {
-				GLchar message[1024];
-				glGetShaderInfoLog(fs, 1024, nullptr, message);
-				::util::fail_error("Failed to compile fragment shader:\n{}", message);
+		/* chunks smaller than this are not worth a thread. */
+		constexpr size_t min_chunk_size = 1 << 20;
+
+		constexpr bool is_digit(char c) { return unsigned(c - '0') < 10; }
+		constexpr bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+		/* parse a float, moving `p` past it. short plain decimals (what exporters
+		 * write) are exact in float arithmetic, everything else uses from_chars. */
+		float parse_float(const char *&p, const char *end) {
+			static constexpr float powers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+			const char *start = p;
+			bool negative = p != end && *p == '-';
+			if(p != end && (*p == '-' || *p == '+')) ++p;
+			uint64_t mantissa = 0;
+			int digits = 0, exponent = 0;
+			for(; p != end && is_digit(*p); ++p, ++digits) mantissa = mantissa * 10 + (*p - '0');
+			if(p != end && *p == '.') {
+				for(++p; p != end && is_digit(*p); ++p, ++digits, --exponent) mantissa = mantissa * 10 + (*p - '0');
 			}
-
-			id = glCreateProgram();
-			glAttachShader(id, fs);
-			glAttachShader(id, vs);
-			glLinkProgram(id);
-			glGetProgramiv(id, GL_LINK_STATUS, &success);
-			if(success != GL_TRUE) {
-				GLsizei log_length = 0;
-				GLchar message[1024];
-				glGetProgramInfoLog(id, 1024, &log_length, message);
-				::util::fail_error("Failed to link shader program:\n{}", message);
+			bool plain = digits > 0 && digits <= 19;
+			if(p != end && (*p == 'e' || *p == 'E')) {
+				++p;
+				bool negative_exp = p != end && *p == '-';
+				if(p != end && (*p == '-' || *p == '+')) ++p;
+				int e = 0;
+				for(; p != end && is_digit(*p); ++p) e = std::min(e * 10 + (*p - '0'), 1000);
+				exponent += negative_exp ? -e : e;
 			}
+			// both the mantissa and the power of ten are exact floats, so one
+			// operation rounds correctly.
+			if(plain && mantissa <= (1 << 24) && exponent >= -10 && exponent <= 10) {
+				float v = exponent < 0 ? float(mantissa) / powers[-exponent] : float(mantissa) * powers[exponent];
+				return negative ? -v : v;
+			}
+			float v = 0.0f;
+			if(*start == '+') ++start;
+			auto [ptr, ec] = std::from_chars(start, end, v);
+			if(ec == std::errc::invalid_argument) ::util::fail_error("Invalid number in .obj file: '{}'", strv(start, std::min<size_t>(end - start, 16)));
+			p = ptr;
+			return v;
 		}
 
-		void set_uniform(const char *name, int v) const {
-			glProgramUniform1i(id, glGetUniformLocation(id, name), v);
+		int64_t parse_int(const char *&p, const char *end) {
+			bool negative = p != end && *p == '-';
+			if(p != end && (*p == '-' || *p == '+')) ++p;
+			int64_t v = 0;
+			for(; p != end && is_digit(*p); ++p) v = v * 10 + (*p - '0');
+			return negative ? -v : v;
 		}
 
-		void set_uniform(const char *name, float v) const {
-			glProgramUniform1f(id, glGetUniformLocation(id, name), v);
+		struct chunk_ {
+			data data;
+			/* negative (relative) indices are resolved against this chunk only,
+			 * the counts of the chunks before it get added when merging. */
+			std::vector<std::pair<size_t, uint8_t>> relative; /* (position in `indices`, mask of attributes). */
+		};
+
+		void parse_chunk_(const char *p, const char *end, chunk_ &chunk) {
+			auto &d = chunk.data;
+			std::vector<std::pair<index, uint8_t>> face; /* with a mask of relative attributes. */
+			// missing trailing components (like in `vt u`) are 0.
+			auto read_floats = [&](std::vector<float> &out, int count) {
+				for(int i = 0; i < count; ++i) {
+					while(p != end && is_space(*p)) ++p;
+					out.push_back(p == end || *p == '\n' ? 0.0f : parse_float(p, end));
+				}
+			};
+			// resolve a 1-based or negative index to 0-based, given how many items there are so far.
+			auto resolve = [&](int64_t i, size_t count, uint8_t attribute, uint8_t &relative) -> int32_t {
+				if(i > 0) return int32_t(i - 1);
+				if(i == 0) ::util::fail_error("Invalid .obj index: 0.");
+				relative |= attribute;
+				return int32_t(int64_t(count) + i);
+			};
+
+			while(p != end) {
+				while(p != end && is_space(*p)) ++p;
+				if(end - p >= 2 && p[0] == 'v' && is_space(p[1])) {
+					p += 2;
+					read_floats(d.positions, 3);
+				} else if(end - p >= 3 && p[0] == 'v' && p[1] == 't' && is_space(p[2])) {
+					p += 3;
+					read_floats(d.texcoords, 2);
+				} else if(end - p >= 3 && p[0] == 'v' && p[1] == 'n' && is_space(p[2])) {
+					p += 3;
+					read_floats(d.normals, 3);
+				} else if(end - p >= 2 && p[0] == 'f' && is_space(p[1])) {
+					p += 2;
+					face.clear();
+					for(;;) {
+						while(p != end && is_space(*p)) ++p;
+						if(p == end || !(is_digit(*p) || *p == '-')) break;
+						index idx { -1, -1, -1 };
+						uint8_t relative = 0;
+						idx.pos = resolve(parse_int(p, end), d.positions.size() / 3, 1, relative);
+						if(p != end && *p == '/') {
+							++p;
+							if(p != end && *p != '/') idx.texcoord = resolve(parse_int(p, end), d.texcoords.size() / 2, 2, relative);
+							if(p != end && *p == '/') {
+								++p;
+								idx.norm = resolve(parse_int(p, end), d.normals.size() / 3, 4, relative);
+							}
+						}
+						face.push_back({ idx, relative });
+					}
+					if(face.size() < 3) ::util::fail_error("Invalid .obj face with {} vertices.", face.size());
+					auto push = [&](const std::pair<index, uint8_t> &corner) {
+						if(corner.second) chunk.relative.push_back({ d.indices.size(), corner.second });
+						d.indices.push_back(corner.first);
+					};
+					for(size_t i = 2; i < face.size(); ++i) {
+						push(face[0]);
+						push(face[i - 1]);
+						push(face[i]);
+					}
+				}
+				while(p != end && *p != '\n') ++p;
+				if(p != end) ++p;
+			}
 		}
 
-		void set_uniform(const char *name, glm::vec2 v) const {
-			glProgramUniform2f(id, glGetUniformLocation(id, name),
-				v.x, v.y);
+		data parse(std::span<const char> text, size_t max_threads = std::thread::hardware_concurrency()) {
+			const char *begin = text.data(), *end = begin + text.size();
+			size_t chunk_count = std::clamp<size_t>(text.size() / min_chunk_size, 1, std::max<size_t>(1, max_threads));
+			std::vector<const char*> bounds(chunk_count + 1, end);
+			bounds[0] = begin;
+			for(size_t i = 1; i < chunk_count; ++i) {
+				const char *p = std::max(begin + text.size() * i / chunk_count, bounds[i - 1]);
+				while(p != end && *p != '\n') ++p;
+				bounds[i] = p == end ? end : p + 1;
+			}
+
+			std::vector<chunk_> chunks(chunk_count);
+			::util::parallel_for(chunk_count, [&](size_t i) {
+				parse_chunk_(bounds[i], bounds[i + 1], chunks[i]);
+			});
+
+			struct offsets { size_t positions = 0, texcoords = 0, normals = 0, indices = 0; };
+			std::vector<offsets> starts(chunk_count + 1);
+			for(size_t i = 0; i < chunk_count; ++i) {
+				const auto &d = chunks[i].data;
+				starts[i + 1] = {
+					starts[i].positions + d.positions.size(),
+					starts[i].texcoords + d.texcoords.size(),
+					starts[i].normals + d.normals.size(),
+					starts[i].indices + d.indices.size(),
+				};
+			}
+			const auto &total = starts[chunk_count];
+
+			data result;
+			result.positions.resize(total.positions);
+			result.texcoords.resize(total.texcoords);
+			result.normals.resize(total.normals);
+			result.indices.resize(total.indices);
+			::util::parallel_for(chunk_count, [&](size_t i) {
+				auto &chunk = chunks[i];
+				const auto &start = starts[i];
+				for(const auto &[at, mask] : chunk.relative) {
+					auto &idx = chunk.data.indices[at];
+					if(mask & 1) idx.pos += start.positions / 3;
+					if(mask & 2) idx.texcoord += start.texcoords / 2;
+					if(mask & 4) idx.norm += start.normals / 3;
+				}
+				for(const auto &idx : chunk.data.indices) {
+					if(idx.pos < 0 || size_t(idx.pos) >= total.positions / 3
+						|| idx.texcoord >= int64_t(total.texcoords / 2) || idx.texcoord < -1
+						|| idx.norm >= int64_t(total.normals / 3) || idx.norm < -1)
+						::util::fail_error("Out of range .obj index: {}/{}/{}", idx.pos + 1, idx.texcoord + 1, idx.norm + 1);
+				}
+				std::ranges::copy(chunk.data.positions, result.positions.begin() + start.positions);
+				std::ranges::copy(chunk.data.texcoords, result.texcoords.begin() + start.texcoords);
+				std::ranges::copy(chunk.data.normals, result.normals.begin() + start.normals);
+				std::ranges::copy(chunk.data.indices, result.indices.begin() + start.indices);
+			});
+			return result;
 		}
 
-		void set_uniform(const char *name, glm::vec3 v) const {
-			glProgramUniform3f(id, glGetUniformLocation(id, name),
-				v.x, v.y, v.z);
+		data parse_file(const stdfs::path &path) {
+			::util::mapped_file file(path, true);
+			auto bytes = file.bytes();
+			return parse({ (const char*)bytes.data(), bytes.size() });
 		}
+	}
 
-		void set_uniform(const char *name, glm::vec4 v) const {
-			glProgramUniform4f(id, glGetUniformLocation(id, name),
-				v.x, v.y, v.z, v.w);
+	/* vertex welding: finds equal vertices with a flat open-addressing table
+	 * keyed on the raw vertex bytes. big inputs are partitioned by hash and each
+	 * partition is welded on its own thread. unique vertices are numbered in
+	 * order of first appearance, so the result is the same for any thread count. */
+	namespace weld {
+		struct options {
+			/* snap every component to a grid of this size before comparing, 0 for exact matches. */
+			float epsilon = 0.0f;
+			/* 0 for the hardware thread count. */
+			size_t max_threads = 0;
+		};
+
+		/* below this many vertices threads are not worth it. */
+		constexpr size_t min_parallel_count = 1 << 16;
+		constexpr uint32_t empty_slot = UINT32_MAX;
+
+		template<size_t Words>
+		struct key_ {
+			uint32_t words[Words];
+			bool operator==(const key_ &) const = default;
+		};
+
+		template<size_t Words>
+		uint64_t hash_(const key_<Words> &key) {
+			uint64_t h = 0;
+			for(size_t i = 0; i < Words; ++i)
+				h = (h ^ key.words[i]) * 0x9e3779b97f4a7c15;
+			// murmur3 finalizer, so that every input bit reaches the low bits used for probing.
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccd;
+			h ^= h >> 33;
+			h *= 0xc4ceb93e63fe53ba;
+			h ^= h >> 33;
+			return h;
 		}
 
-		void set_uniform(const char *name, const glm::mat4 &v) const {
-			glProgramUniformMatrix4fv(id, glGetUniformLocation(id, name),
-				1, GL_FALSE, glm::value_ptr(v));
+		/* canonical form of a vertex: snapped to the grid, -0 turned into 0. */
+		template<typename V, size_t Words = sizeof(V) / 4>
+		key_<Words> make_key_(const V &vertex, float epsilon) {
+			key_<Words> key;
+			std::memcpy(key.words, &vertex, sizeof(V));
+			for(auto &word : key.words) {
+				float f = std::bit_cast<float>(word);
+				if(epsilon > 0.0f) f = std::round(f / epsilon);
+				if(f == 0.0f) f = 0.0f;
+				word = std::bit_cast<uint32_t>(f);
+			}
+			return key;
 		}
-	};
 
-	class texture {
-		friend ::gfx::renderer;
-		GLuint id;
-		glm::ivec2 size;
-	public:
-		void unload(::res::res_manager &m, const ::res::res_id_type &rid) {
-			glDeleteTextures(1, &id);
+		/* for each i in `order`, the smallest j in `order` with an equal key. */
+		template<typename Key>
+		void find_first_(std::span<const Key> keys, std::span<const uint64_t> hashes,
+			std::span<const uint32_t> order, std::span<uint32_t> first) {
+			size_t capacity = std::bit_ceil(std::max<size_t>(order.size() * 2, 16));
+			std::vector<uint32_t> table(capacity, empty_slot);
+			for(uint32_t i : order) {
+				size_t slot = hashes[i] & (capacity - 1);
+				for(;; slot = (slot + 1) & (capacity - 1)) {
+					uint32_t j = table[slot];
+					if(j == empty_slot) {
+						table[slot] = first[i] = i;
+						break;
+					}
+					if(hashes[j] == hashes[i] && keys[j] == keys[i]) {
+						first[i] = j;
+						break;
+					}
+				}
+			}
 		}
 
-		void load_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &path) {
-			clog.println("path: {}", path);
-			
-			int channels;
-			uint8_t *data = stbi_load(path.c_str(), &size.x, &size.y, &channels, 4);
-			glCreateTextures(GL_TEXTURE_2D, 1, &id);
-			glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-			glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
-			glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		/* fills `remap` with the new index of every vertex, returns the unique count. */
+		template<typename V>
+		size_t build_remap(std::span<const V> vertices, std::span<uint32_t> remap, const options &opts = {}) {
+			static_assert(std::is_trivially_copyable_v<V> && sizeof(V) % 4 == 0, "vertices are compared as 32-bit words");
+			using key_type = key_<sizeof(V) / 4>;
+			assert(remap.size() == vertices.size());
+			assert(vertices.size() < empty_slot);
+			size_t count = vertices.size();
+
+			size_t threads = opts.max_threads ? opts.max_threads : std::thread::hardware_concurrency();
+			threads = count < min_parallel_count ? 1 : std::clamp<size_t>(threads, 1, count / min_parallel_count);
+
+			std::vector<key_type> keys(count);
+			std::vector<uint64_t> hashes(count);
+			std::vector<uint32_t> first(count);
+
+			if(threads == 1) {
+				for(size_t i = 0; i < count; ++i) {
+					keys[i] = make_key_(vertices[i], opts.epsilon);
+					hashes[i] = hash_(keys[i]);
+				}
+				std::vector<uint32_t> order(count);
+				std::iota(order.begin(), order.end(), 0);
+				find_first_<key_type>(keys, hashes, order, first);
+			} else {
+				// partition by the high bits of the hash, a stable counting sort keeps
+				// every partition in input order.
+				size_t partitions = threads;
+				auto partition_of = [&](uint64_t hash) { return size_t((hash >> 32) * partitions >> 32); };
+				auto range_of = [&](size_t t) { return std::pair(count * t / threads, count * (t + 1) / threads); };
+				std::vector<size_t> counts(threads * partitions); /* [chunk][partition]. */
+				::util::parallel_for(threads, [&](size_t t) {
+					auto [begin, end] = range_of(t);
+					for(size_t i = begin; i < end; ++i) {
+						keys[i] = make_key_(vertices[i], opts.epsilon);
+						hashes[i] = hash_(keys[i]);
+						++counts[t * partitions + partition_of(hashes[i])];
+					}
+				});
+
+				std::vector<size_t> starts(threads * partitions), partition_starts(partitions + 1);
+				size_t offset = 0;
+				for(size_t p = 0; p < partitions; ++p) {
+					partition_starts[p] = offset;
+					for(size_t t = 0; t < threads; ++t) {
+						starts[t * partitions + p] = offset;
+						offset += counts[t * partitions + p];
+					}
+				}
+				partition_starts[partitions] = offset;
+
+				std::vector<uint32_t> order(count);
+				::util::parallel_for(threads, [&](size_t t) {
+					auto [begin, end] = range_of(t);
+					for(size_t i = begin; i < end; ++i)
+						order[starts[t * partitions + partition_of(hashes[i])]++] = i;
+				});
+				::util::parallel_for(partitions, [&](size_t p) {
+					std::span<const uint32_t> part(order.data() + partition_starts[p], order.data() + partition_starts[p + 1]);
+					find_first_<key_type>(keys, hashes, part, first);
+				});
+			}
 
-			glTextureStorage2D(id, 1, GL_RGBA8, size.x, size.y);
-			glTextureSubImage2D(id, 0, 0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, data);
-			stbi_image_free(data);
+			// first occurrences come before their duplicates, so one pass numbers them.
+			size_t unique = 0;
+			for(size_t i = 0; i < count; ++i)
+				remap[i] = first[i] == i ? unique++ : remap[first[i]];
+			return unique;
 		}
 
-		glm::ivec2 get_size() const { return size; }
-	};
+		/* weld `vertices` into `out` (first occurrences, in order) and the index of
+		 * each input vertex in `out` into `remap`. */
+		template<typename V>
+		void apply(std::span<const V> vertices, std::vector<V> &out, std::span<uint32_t> remap, const options &opts = {}) {
+			out.resize(build_remap(vertices, remap, opts));
+			size_t next = 0;
+			for(size_t i = 0; i < vertices.size(); ++i)
+				if(remap[i] == next) out[next++] = vertices[i];
+		}
+	}
 
-	enum class mesh_mode {
-		triangle_strip = GL_TRIANGLE_STRIP,
-		triangle_fan = GL_TRIANGLE_FAN,
-		triangles = GL_TRIANGLES,
-	};
+	/* triangle and vertex order optimization for indexed triangle lists:
+	 * tipsify (sander et al. 2007) for the post-transform cache, then cluster
+	 * ordering against overdraw, then renumbering vertices for fetch locality. */
+	namespace vcache {
+		/* fifo size assumed by the optimizer and by `analyze`. */
+		constexpr size_t default_cache_size = 16;
+
+		struct stats {
+			size_t triangles = 0, vertices = 0, transformed = 0; /* cache misses. */
+
+			/* average cache miss ratio, transformed vertices per triangle (0.5 is ideal). */
+			float acmr() const { return triangles ? float(transformed) / triangles : 0.0f; }
+			/* average transform to vertex ratio (1 is ideal). */
+			float atvr() const { return vertices ? float(transformed) / vertices : 0.0f; }
+
+			stats &operator+=(const stats &other) {
+				triangles += other.triangles;
+				vertices += other.vertices;
+				transformed += other.transformed;
+				return *this;
+			}
+		};
 
-	class mesh {
-		friend ::gfx::renderer;
-		bool indexed;
-		GLuint vao, vbo, ebo;
-		GLsizei vertex_count, index_count;
-		mesh_mode mode;
-	public:
-		struct vertex_type {
-			glm::vec3 pos;
-			glm::vec3 norm;
-			glm::vec2 texcoord;
+		/* simulate a fifo post-transform cache over `indices`. */
+		stats analyze(std::span<const uint32_t> indices, size_t vertex_count, size_t cache_size = default_cache_size) {
+			stats result { indices.size() / 3, vertex_count, 0 };
+			// a vertex is cached while fewer than `cache_size` misses happened since its own.
+			std::vector<size_t> missed_at(vertex_count, 0);
+			for(uint32_t v : indices) {
+				if(missed_at[v] == 0 || result.transformed + 1 - missed_at[v] > cache_size)
+					missed_at[v] = ++result.transformed;
+			}
+			return result;
+		}
 
-			bool operator==(const vertex_type &other) const {
-				return pos == other.pos && norm == other.norm && texcoord == other.texcoord;
+		/* reorder triangles for the post-transform cache. the returned clusters are
+		 * the first triangle of every run that started from a dead end, which is
+		 * where `order_for_overdraw` may reorder without hurting the cache much. */
+		std::vector<uint32_t> tipsify(std::span<const uint32_t> indices, size_t vertex_count,
+			std::vector<uint32_t> &clusters, size_t cache_size = default_cache_size) {
+			size_t triangle_count = indices.size() / 3;
+
+			// triangles around every vertex, as offsets into one array.
+			std::vector<uint32_t> live(vertex_count, 0), adjacency_start(vertex_count + 1, 0);
+			for(size_t i = 0; i < triangle_count * 3; ++i) ++live[indices[i]];
+			for(size_t v = 0; v < vertex_count; ++v) adjacency_start[v + 1] = adjacency_start[v] + live[v];
+			std::vector<uint32_t> adjacency(adjacency_start[vertex_count]);
+			{
+				auto fill = adjacency_start;
+				for(size_t i = 0; i < triangle_count * 3; ++i) adjacency[fill[indices[i]]++] = i / 3;
 			}
-		};
 
-		using index_type = uint16_t;
+			std::vector<size_t> cached_at(vertex_count, 0); /* time stamp of the last miss. */
+			std::vector<bool> emitted(triangle_count, false);
+			std::vector<uint32_t> dead_end, candidates, result;
+			result.reserve(triangle_count * 3);
+			clusters.clear();
+			size_t time = cache_size + 1, cursor = 0;
+
+			auto skip_dead_end = [&]() -> int64_t {
+				while(!dead_end.empty()) {
+					uint32_t v = dead_end.back();
+					dead_end.pop_back();
+					if(live[v] > 0) return v;
+				}
+				for(; cursor < vertex_count; ++cursor)
+					if(live[cursor] > 0) return cursor;
+				return -1;
+			};
+
+			int64_t fan = triangle_count ? skip_dead_end() : -1;
+			bool from_dead_end = true;
+			while(fan >= 0) {
+				candidates.clear();
+				for(uint32_t a = adjacency_start[fan]; a < adjacency_start[fan + 1]; ++a) {
+					uint32_t t = adjacency[a];
+					if(emitted[t]) continue;
+					if(from_dead_end) {
+						clusters.push_back(result.size() / 3);
+						from_dead_end = false;
+					}
+					for(size_t k = 0; k < 3; ++k) {
+						uint32_t v = indices[3 * t + k];
+						result.push_back(v);
+						dead_end.push_back(v);
+						candidates.push_back(v);
+						--live[v];
+						if(time - cached_at[v] > cache_size) cached_at[v] = time++;
+					}
+					emitted[t] = true;
+				}
 
-		void unload(::res::res_manager &m, const ::res::res_id_type &id) {
-			if(indexed) glDeleteBuffers(1, &ebo);
-			glDeleteBuffers(1, &vbo);
-			glDeleteVertexArrays(1, &vao);
+				// prefer the candidate that stays in the cache the longest and still has triangles.
+				int64_t best = -1, best_priority = -1;
+				for(uint32_t v : candidates) {
+					if(live[v] == 0) continue;
+					int64_t priority = 0;
+					if(time - cached_at[v] + 2 * live[v] <= cache_size) priority = time - cached_at[v];
+					if(priority > best_priority) {
+						best = v;
+						best_priority = priority;
+					}
+				}
+				from_dead_end = best < 0;
+				fan = from_dead_end ? skip_dead_end() : best;
+			}
+			return result;
 		}
 
-		void load_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
-			clog.println("path: {}", path);
-			if(path.extension() == ".gltf") {
-				load_from_gltf(m, id, path.c_str());
-			} else if(path.extension() == ".obj") {
-				load_from_obj(m, id, path.c_str());
+		/* reorder the clusters of a tipsified triangle list front to back from the
+		 * outside in (sander et al. 2007), so that self-occluding meshes draw their
+		 * outward facing parts first. clusters are split further at points where
+		 * the cache miss ratio so far is within `threshold` of the whole mesh's. */
+		template<typename V>
+		void order_for_overdraw(std::span<uint32_t> indices, std::span<const V> vertices,
+			const std::vector<uint32_t> &hard_clusters, float threshold = 1.05f, size_t cache_size = default_cache_size) {
+			size_t triangle_count = indices.size() / 3;
+			if(triangle_count == 0) return;
+			float target = analyze(indices, vertices.size(), cache_size).acmr() * threshold;
+
+			// every cluster is simulated from a cold cache: only misses after
+			// `start_misses` count as cached.
+			std::vector<uint32_t> clusters;
+			std::vector<size_t> cached_at(vertices.size(), 0);
+			size_t misses = 0;
+			for(size_t c = 0; c < hard_clusters.size(); ++c) {
+				size_t begin = hard_clusters[c], end = c + 1 < hard_clusters.size() ? hard_clusters[c + 1] : triangle_count;
+				size_t start = begin, start_misses = misses;
+				clusters.push_back(begin);
+				for(size_t t = begin; t < end; ++t) {
+					for(size_t k = 0; k < 3; ++k) {
+						uint32_t v = indices[3 * t + k];
+						if(cached_at[v] <= start_misses || misses + 1 - cached_at[v] > cache_size) cached_at[v] = ++misses;
+					}
+					if(t + 1 < end && float(misses - start_misses) / (t + 1 - start) <= target) {
+						clusters.push_back(t + 1);
+						start = t + 1;
+						start_misses = misses;
+					}
+				}
+			}
+
+			glm::vec3 mesh_center {};
+			float mesh_area = 0.0f;
+			struct cluster_info { float sort_key; uint32_t begin, end; };
+			std::vector<cluster_info> infos(clusters.size());
+			std::vector<glm::vec3> centers(clusters.size()), normals(clusters.size());
+			for(size_t c = 0; c < clusters.size(); ++c) {
+				auto &info = infos[c];
+				info.begin = clusters[c];
+				info.end = c + 1 < clusters.size() ? clusters[c + 1] : triangle_count;
+				float area = 0.0f;
+				for(size_t t = info.begin; t < info.end; ++t) {
+					const auto &a = vertices[indices[3 * t + 0]].pos;
+					const auto &b = vertices[indices[3 * t + 1]].pos;
+					const auto &d = vertices[indices[3 * t + 2]].pos;
+					auto normal = glm::cross(b - a, d - a); /* length is twice the area. */
+					float triangle_area = glm::length(normal) * 0.5f;
+					centers[c] += (a + b + d) * (triangle_area / 3.0f);
+					normals[c] += normal;
+					area += triangle_area;
+				}
+				mesh_center += centers[c];
+				mesh_area += area;
+				if(area > 0.0f) centers[c] /= area;
+			}
+			if(mesh_area > 0.0f) mesh_center /= mesh_area;
+			for(size_t c = 0; c < clusters.size(); ++c) {
+				float length = glm::length(normals[c]);
+				infos[c].sort_key = length > 0.0f ? glm::dot(centers[c] - mesh_center, normals[c] / length) : 0.0f;
+			}
+			std::ranges::stable_sort(infos, std::greater<>{}, &cluster_info::sort_key);
+
+			std::vector<uint32_t> result;
+			result.reserve(indices.size());
+			for(const auto &info : infos)
+				result.insert(result.end(), indices.begin() + 3 * info.begin, indices.begin() + 3 * info.end);
+			std::ranges::copy(result, indices.begin());
+		}
+
+		/* renumber vertices in order of first use, so that fetches walk the
+		 * vertex buffer forward. unused vertices are moved to the end. */
+		template<typename V>
+		void remap_for_fetch(std::span<V> vertices, std::span<uint32_t> indices) {
+			constexpr uint32_t unused = UINT32_MAX;
+			std::vector<uint32_t> remap(vertices.size(), unused);
+			std::vector<V> reordered;
+			reordered.reserve(vertices.size());
+			for(auto &i : indices) {
+				if(remap[i] == unused) {
+					remap[i] = reordered.size();
+					reordered.push_back(vertices[i]);
+				}
+				i = remap[i];
+			}
+			for(size_t v = 0; v < vertices.size(); ++v)
+				if(remap[v] == unused) reordered.push_back(vertices[v]);
+			std::ranges::copy(reordered, vertices.begin());
+		}
+
+		/* all of the above, returns the cache statistics before and after. */
+		template<typename V>
+		std::pair<stats, stats> optimize(std::span<V> vertices, std::span<uint32_t> indices, size_t cache_size = default_cache_size) {
+			auto before = analyze(indices, vertices.size(), cache_size);
+			std::vector<uint32_t> clusters;
+			auto ordered = tipsify(indices, vertices.size(), clusters, cache_size);
+			std::ranges::copy(ordered, indices.begin());
+			order_for_overdraw<V>(indices, vertices, clusters, 1.05f, cache_size);
+			remap_for_fetch(vertices, indices);
+			return { before, analyze(indices, vertices.size(), cache_size) };
+		}
+	}
+
+	/* level of detail generation by edge collapse, ordered by quadric error
+	 * (garland and heckbert 1997). vertices only ever move onto one of their
+	 * neighbours, so the simplified index lists reuse the original vertices. */
+	namespace lod {
+		/* sum of weighted squared distances to a set of planes. */
+		struct quadric {
+			double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+			double b0 = 0, b1 = 0, b2 = 0, c = 0, weight = 0;
+
+			/* the plane dot(`normal`, p) + `d` = 0, `normal` is unit length. */
+			static quadric plane(const glm::vec3 &normal, float d, float weight) {
+				double x = normal.x, y = normal.y, z = normal.z, w = weight;
+				return {
+					w * x * x, w * y * y, w * z * z, w * x * y, w * x * z, w * y * z,
+					w * x * d, w * y * d, w * z * d, w * double(d) * d, w
+				};
+			}
+
+			quadric &operator+=(const quadric &other) {
+				a00 += other.a00; a11 += other.a11; a22 += other.a22;
+				a01 += other.a01; a02 += other.a02; a12 += other.a12;
+				b0 += other.b0; b1 += other.b1; b2 += other.b2;
+				c += other.c; weight += other.weight;
+				return *this;
+			}
+
+			quadric operator+(const quadric &other) const { return quadric(*this) += other; }
+
+			/* mean squared distance of `p` to the planes. */
+			float error(const glm::vec3 &p) const {
+				double x = p.x, y = p.y, z = p.z;
+				double r = a00 * x * x + a11 * y * y + a22 * z * z
+					+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+					+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+				return weight > 0.0 ? float(std::max(r, 0.0) / weight) : 0.0f;
+			}
+		};
+
+		/* open edges are weighted this much more than triangles of the same size. */
+		constexpr float border_weight = 10.0f;
+
+		/* how a vertex may move. seam vertices share their position with one
+		 * other vertex (a uv or normal seam) and move together with it along the
+		 * seam, border vertices only move along the open border. */
+		enum class vertex_kind_ : uint8_t { manifold, border, seam, locked };
+
+		/* collapse edges of the triangle list `indices` until it has at most
+		 * `target_index_count` indices, or until the next collapse would move the
+		 * surface further than `target_error`. returns the new indices, and the
+		 * largest error reached (as a distance) in `result_error`. */
+		template<typename V>
+		std::vector<uint32_t> simplify(std::span<const V> vertices, std::span<const uint32_t> indices,
+			size_t target_index_count, float target_error, float *result_error = nullptr) {
+			constexpr uint32_t none = UINT32_MAX;
+			size_t vertex_count = vertices.size();
+			std::vector<uint32_t> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+
+			std::vector<glm::vec3> positions(vertex_count);
+			for(size_t v = 0; v < vertex_count; ++v) positions[v] = vertices[v].pos;
+			std::vector<uint32_t> group(vertex_count); /* vertices at the same position. */
+			size_t group_count = ::gfx::weld::build_remap<glm::vec3>(positions, group);
+
+			std::vector<uint32_t> adjacency_start(vertex_count + 1), adjacency; /* triangles around vertices. */
+			auto has_edge = [&](uint32_t a, uint32_t b) {
+				for(uint32_t k = adjacency_start[a]; k < adjacency_start[a + 1]; ++k) {
+					const uint32_t *t = &result[3 * adjacency[k]];
+					if((t[0] == a && t[1] == b) || (t[1] == a && t[2] == b) || (t[2] == a && t[0] == b)) return true;
+				}
+				return false;
+			};
+			auto open_between = [&](uint32_t a, uint32_t b) {
+				bool ab = has_edge(a, b), ba = has_edge(b, a);
+				return ab != ba;
+			};
+
+			std::vector<quadric> quadrics(group_count);
+			for(size_t i = 0; i < result.size(); i += 3) {
+				const glm::vec3 &a = positions[result[i]], &b = positions[result[i + 1]], &c = positions[result[i + 2]];
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float length = glm::length(normal); /* twice the area. */
+				if(length == 0.0f) continue;
+				normal /= length;
+				auto q = quadric::plane(normal, -glm::dot(normal, a), length * 0.5f);
+				for(size_t k = 0; k < 3; ++k) quadrics[group[result[i + k]]] += q;
+			}
+
+			std::vector<uint8_t> open_out(vertex_count), open_in(vertex_count);
+			std::vector<uint32_t> group_size(group_count), group_first(group_count), twin(vertex_count), remap(vertex_count);
+			std::vector<vertex_kind_> kind(vertex_count);
+			std::vector<bool> touched(group_count);
+			struct collapse { uint32_t from, to; float error; };
+			std::vector<collapse> collapses;
+			float reached = 0.0f;
+
+			for(bool first_pass = true; result.size() > target_index_count; first_pass = false) {
+				std::ranges::fill(adjacency_start, 0);
+				for(uint32_t v : result) ++adjacency_start[v + 1];
+				for(size_t v = 0; v < vertex_count; ++v) adjacency_start[v + 1] += adjacency_start[v];
+				adjacency.resize(result.size());
+				{
+					auto fill = adjacency_start;
+					for(size_t i = 0; i < result.size(); ++i) adjacency[fill[result[i]]++] = i / 3;
+				}
+
+				std::ranges::fill(open_out, 0);
+				std::ranges::fill(open_in, 0);
+				for(size_t i = 0; i < result.size(); i += 3) {
+					for(size_t e = 0; e < 3; ++e) {
+						uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+						if(has_edge(b, a)) continue;
+						open_out[a] = std::min(open_out[a] + 1, 2);
+						open_in[b] = std::min(open_in[b] + 1, 2);
+						if(!first_pass) continue;
+						// keep open edges in place with a plane through the edge, perpendicular to the triangle.
+						const glm::vec3 &pa = positions[a], &pb = positions[b], &pc = positions[result[i + (e + 2) % 3]];
+						glm::vec3 edge = pb - pa, normal = glm::cross(glm::cross(edge, pc - pa), edge);
+						float length = glm::length(normal);
+						if(length == 0.0f) continue;
+						normal /= length;
+						auto q = quadric::plane(normal, -glm::dot(normal, pa), border_weight * glm::dot(edge, edge));
+						quadrics[group[a]] += q;
+						quadrics[group[b]] += q;
+					}
+				}
+
+				std::ranges::fill(group_size, 0);
+				for(uint32_t v = 0; v < vertex_count; ++v) {
+					if(adjacency_start[v] == adjacency_start[v + 1]) continue;
+					uint32_t g = group[v];
+					if(group_size[g]++ == 0) group_first[g] = v;
+					else twin[v] = group_first[g], twin[group_first[g]] = v;
+				}
+				for(uint32_t v = 0; v < vertex_count; ++v) {
+					if(adjacency_start[v] == adjacency_start[v + 1]) continue;
+					size_t size = group_size[group[v]];
+					bool one_open = open_out[v] == 1 && open_in[v] == 1;
+					if(size == 1 && open_out[v] == 0 && open_in[v] == 0) kind[v] = vertex_kind_::manifold;
+					else if(size == 1 && one_open) kind[v] = vertex_kind_::border;
+					else if(size == 2 && one_open && open_out[twin[v]] == 1 && open_in[twin[v]] == 1) kind[v] = vertex_kind_::seam;
+					else kind[v] = vertex_kind_::locked;
+				}
+
+				auto can_collapse = [&](uint32_t v, uint32_t w) {
+					if(group[v] == group[w]) return false;
+					switch(kind[v]) {
+					case vertex_kind_::manifold: return true;
+					case vertex_kind_::border:
+						return (kind[w] == vertex_kind_::border || kind[w] == vertex_kind_::locked) && open_between(v, w);
+					case vertex_kind_::seam:
+						return kind[w] == vertex_kind_::seam && open_between(v, w) && open_between(twin[v], twin[w]);
+					default: return false;
+					}
+				};
+
+				collapses.clear();
+				for(size_t i = 0; i < result.size(); i += 3) {
+					for(size_t e = 0; e < 3; ++e) {
+						uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+						if(a > b && has_edge(b, a)) continue; /* the other triangle has it. */
+						quadric q = quadrics[group[a]] + quadrics[group[b]];
+						collapse best { none, none, INFINITY };
+						if(can_collapse(a, b)) best = { a, b, q.error(positions[b]) };
+						if(can_collapse(b, a)) {
+							float error = q.error(positions[a]);
+							if(error < best.error) best = { b, a, error };
+						}
+						if(best.from != none) collapses.push_back(best);
+					}
+				}
+				std::ranges::sort(collapses, {}, &collapse::error);
+
+				// whether moving `v` onto `w` flips or degenerates any of the triangles that stay.
+				auto flips = [&](uint32_t v, uint32_t w) {
+					for(uint32_t k = adjacency_start[v]; k < adjacency_start[v + 1]; ++k) {
+						uint32_t t[3];
+						for(size_t e = 0; e < 3; ++e) t[e] = remap[result[3 * adjacency[k] + e]];
+						if(t[0] == w || t[1] == w || t[2] == w) continue;
+						glm::vec3 p[3], q[3];
+						for(size_t e = 0; e < 3; ++e) {
+							if(t[e] != v && group[t[e]] == group[w]) return true;
+							p[e] = positions[t[e]];
+							q[e] = t[e] == v ? positions[w] : p[e];
+						}
+						glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]), after = glm::cross(q[1] - q[0], q[2] - q[0]);
+						if(glm::dot(before, after) < 0.25f * glm::length(before) * glm::length(after)) return true;
+					}
+					return false;
+				};
+				auto removed = [&](uint32_t v, uint32_t w) {
+					size_t count = 0;
+					for(uint32_t k = adjacency_start[v]; k < adjacency_start[v + 1]; ++k) {
+						const uint32_t *t = &result[3 * adjacency[k]];
+						count += remap[t[0]] == w || remap[t[1]] == w || remap[t[2]] == w;
+					}
+					return count;
+				};
+
+				std::iota(remap.begin(), remap.end(), 0);
+				std::fill(touched.begin(), touched.end(), false);
+				size_t triangles = result.size() / 3, applied = 0;
+				for(const auto &c : collapses) {
+					if(triangles * 3 <= target_index_count || c.error > target_error * target_error) break;
+					if(touched[group[c.from]] || touched[group[c.to]]) continue;
+					bool seam = kind[c.from] == vertex_kind_::seam;
+					if(flips(c.from, c.to) || (seam && flips(twin[c.from], twin[c.to]))) continue;
+					triangles -= removed(c.from, c.to) + (seam ? removed(twin[c.from], twin[c.to]) : 0);
+					remap[c.from] = c.to;
+					if(seam) remap[twin[c.from]] = twin[c.to];
+					quadrics[group[c.to]] += quadrics[group[c.from]];
+					touched[group[c.from]] = touched[group[c.to]] = true;
+					reached = std::max(reached, c.error);
+					++applied;
+				}
+
+				size_t write = 0;
+				for(size_t i = 0; i < result.size(); i += 3) {
+					uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+					if(group[a] == group[b] || group[b] == group[c] || group[a] == group[c]) continue;
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+				result.resize(write);
+				if(applied == 0) break;
+			}
+
+			if(result_error) *result_error = std::sqrt(reached);
+			return result;
+		}
+	}
+
+	/* bounding sphere. */
+	struct sphere {
+		glm::vec3 center { 0.0f };
+		float radius = 0.0f;
+	};
+
+	/* axis aligned bounding box. */
+	struct aabb {
+		glm::vec3 lo { 0.0f }, hi { 0.0f };
+
+		/* the box around this one transformed by `m` (arvo 1990). */
+		aabb transformed(const glm::mat4 &m) const {
+			glm::vec3 center = glm::vec3(m * glm::vec4((lo + hi) * 0.5f, 1.0f));
+			glm::vec3 extent = (hi - lo) * 0.5f, result { 0.0f };
+			for(int c = 0; c < 3; ++c) result += glm::abs(glm::vec3(m[c])) * extent[c];
+			return { center - result, center + result };
+		}
+	};
+
+	/* boxes as centers and half extents with one array per component, the
+	 * layout `frustum::cull` reads several boxes at a time from. */
+	struct box_batch {
+		std::vector<float> center[3], extent[3];
+
+		size_t size() const { return center[0].size(); }
+
+		void clear() {
+			for(int c = 0; c < 3; ++c) {
+				center[c].clear();
+				extent[c].clear();
+			}
+		}
+
+		void push(const ::gfx::aabb &box) {
+			for(int c = 0; c < 3; ++c) {
+				center[c].push_back((box.lo[c] + box.hi[c]) * 0.5f);
+				extent[c].push_back((box.hi[c] - box.lo[c]) * 0.5f);
+			}
+		}
+	};
+
+	/* the six planes of a view frustum (gribb and hartmann 2001), normals
+	 * pointing inwards. planes taken from a model view projection matrix are
+	 * in model space. */
+	struct frustum {
+		std::array<glm::vec4, 6> planes;
+
+		static frustum from_matrix(const glm::mat4 &m) {
+			glm::vec4 row[4];
+			for(int i = 0; i < 4; ++i) row[i] = { m[0][i], m[1][i], m[2][i], m[3][i] };
+			frustum result { {
+				row[3] + row[0], row[3] - row[0],
+				row[3] + row[1], row[3] - row[1],
+				row[3] + row[2], row[3] - row[2],
+			} };
+			for(auto &plane : result.planes) {
+				float length = glm::length(glm::vec3(plane));
+				if(length > 0.0f) plane /= length;
+			}
+			return result;
+		}
+
+		bool intersects(const ::gfx::sphere &s) const {
+			for(const auto &plane : planes)
+				if(glm::dot(glm::vec3(plane), s.center) + plane.w < -s.radius) return false;
+			return true;
+		}
+
+		/* false only if the box is entirely outside of one of the planes. */
+		bool intersects(const ::gfx::aabb &box) const {
+			glm::vec3 center = (box.lo + box.hi) * 0.5f, extent = (box.hi - box.lo) * 0.5f;
+			for(const auto &plane : planes)
+				if(glm::dot(glm::vec3(plane), center) + plane.w < -glm::dot(glm::abs(glm::vec3(plane)), extent)) return false;
+			return true;
+		}
+
+		/* append the indices of the boxes in `batch` that intersect the frustum,
+		 * as `intersects` decides, to `visible`. tests 8 boxes at once when built
+		 * with avx, otherwise 4 with sse. */
+		void cull(const ::gfx::box_batch &batch, std::vector<uint32_t> &visible) const {
+			size_t count = batch.size(), i = 0;
+			const float *cx = batch.center[0].data(), *cy = batch.center[1].data(), *cz = batch.center[2].data();
+			const float *ex = batch.extent[0].data(), *ey = batch.extent[1].data(), *ez = batch.extent[2].data();
+#if defined(__AVX__)
+			for(; i + 8 <= count; i += 8) {
+				__m256 x = _mm256_loadu_ps(cx + i), y = _mm256_loadu_ps(cy + i), z = _mm256_loadu_ps(cz + i);
+				__m256 w = _mm256_loadu_ps(ex + i), h = _mm256_loadu_ps(ey + i), d = _mm256_loadu_ps(ez + i);
+				__m256 outside = _mm256_setzero_ps();
+				for(const auto &plane : planes) {
+					__m256 distance = _mm256_add_ps(
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y)),
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), z), _mm256_set1_ps(plane.w)));
+					__m256 radius = _mm256_add_ps(
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::abs(plane.x)), w), _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.y)), h)),
+						_mm256_mul_ps(_mm256_set1_ps(std::abs(plane.z)), d));
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+				}
+				for(unsigned mask = ~_mm256_movemask_ps(outside) & 0xff; mask != 0; mask &= mask - 1)
+					visible.push_back(i + std::countr_zero(mask));
+			}
+#endif
+#if defined(__SSE__)
+			for(; i + 4 <= count; i += 4) {
+				__m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+				__m128 w = _mm_loadu_ps(ex + i), h = _mm_loadu_ps(ey + i), d = _mm_loadu_ps(ez + i);
+				__m128 outside = _mm_setzero_ps();
+				for(const auto &plane : planes) {
+					__m128 distance = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+					__m128 radius = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), w), _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), h)),
+						_mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), d));
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+				}
+				for(unsigned mask = ~_mm_movemask_ps(outside) & 0xf; mask != 0; mask &= mask - 1)
+					visible.push_back(i + std::countr_zero(mask));
+			}
+#endif
+			for(; i < count; ++i) {
+				bool inside = true;
+				for(const auto &plane : planes) {
+					float distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+					float radius = std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i] + std::abs(plane.z) * ez[i];
+					if(distance + radius < 0.0f) inside = false;
+				}
+				if(inside) visible.push_back(i);
+			}
+		}
+	};
+
+	/* partitioning of triangle lists into small clusters (meshlets) that can
+	 * be culled on their own, against the frustum with their bounding sphere
+	 * and as a whole backfacing with their normal cone. */
+	namespace cluster {
+		constexpr size_t max_vertices = 64, max_triangles = 124;
+
+		struct meshlet {
+			::gfx::sphere bounds;
+			/* backfacing when seen from anywhere in the cone at `cone_apex` around
+			 * `cone_axis` with this cosine, 1 if it never is. */
+			glm::vec3 cone_apex, cone_axis;
+			float cone_cutoff;
+			uint32_t first_index, index_count; /* in the index buffer. */
+		};
+
+		/* whether the whole meshlet faces away from `camera` (in the same space). */
+		inline bool backfacing(const meshlet &m, const glm::vec3 &camera) {
+			glm::vec3 direction = m.cone_apex - camera;
+			float length = glm::length(direction);
+			return length > 0.0f && glm::dot(direction / length, m.cone_axis) >= m.cone_cutoff;
+		}
+
+		/* bounding sphere and normal cone of the triangles `indices`, like meshoptimizer does. */
+		template<typename V>
+		void compute_bounds(meshlet &m, std::span<const V> vertices, std::span<const uint32_t> indices) {
+			glm::vec3 lo = vertices[indices[0]].pos, hi = lo;
+			for(uint32_t i : indices) {
+				lo = glm::min(lo, vertices[i].pos);
+				hi = glm::max(hi, vertices[i].pos);
+			}
+			m.bounds = { (lo + hi) * 0.5f, 0.0f };
+			for(uint32_t i : indices)
+				m.bounds.radius = std::max(m.bounds.radius, glm::distance(vertices[i].pos, m.bounds.center));
+
+			std::vector<glm::vec3> normals;
+			glm::vec3 axis { 0.0f };
+			for(size_t t = 0; t + 2 < indices.size(); t += 3) {
+				const glm::vec3 &a = vertices[indices[t]].pos, &b = vertices[indices[t + 1]].pos, &c = vertices[indices[t + 2]].pos;
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float length = glm::length(normal);
+				normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+				axis += normals.back();
+			}
+			m.cone_apex = m.bounds.center;
+			m.cone_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+			m.cone_cutoff = 1.0f;
+			float axis_length = glm::length(axis);
+			if(axis_length == 0.0f) return;
+			axis /= axis_length;
+
+			float min_dot = 1.0f;
+			for(const auto &normal : normals)
+				if(normal != glm::vec3(0.0f)) min_dot = std::min(min_dot, glm::dot(normal, axis));
+			m.cone_axis = axis;
+			if(min_dot <= 0.1f) return; /* wider than ~84 degrees, never fully backfacing. */
+			m.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+
+			// move the apex back along the axis until it is behind every triangle.
+			float max_t = 0.0f;
+			for(size_t t = 0; t < normals.size(); ++t) {
+				if(normals[t] == glm::vec3(0.0f)) continue;
+				float distance = glm::dot(m.bounds.center - vertices[indices[3 * t]].pos, normals[t]);
+				max_t = std::max(max_t, distance / glm::dot(axis, normals[t]));
+			}
+			m.cone_apex = m.bounds.center - axis * max_t;
+		}
+
+		/* how many of the next unused triangles (in input order) are looked at
+		 * when a meshlet has no neighbouring triangle left to grow with. */
+		constexpr size_t nearby_window = 32;
+
+		/* reorder the triangles of `indices` into meshlets of at most
+		 * `max_vertices` vertices and `max_triangles` triangles. meshlets are
+		 * grown from a seed triangle, preferring triangles that add the fewest
+		 * vertices and then the ones facing the same way as the meshlet so far.
+		 * once none are left, a nearby triangle close to the meshlet's bounding
+		 * box continues it. triangles in a meshlet are tipsified, so the input is
+		 * best already ordered for the vertex cache. the returned meshlets' first
+		 * indices are relative to `indices`. */
+		template<typename V>
+		std::vector<meshlet> build(std::span<const V> vertices, std::span<uint32_t> indices) {
+			size_t triangle_count = indices.size() / 3, vertex_count = vertices.size();
+			std::vector<uint32_t> adjacency_start(vertex_count + 1, 0), adjacency(triangle_count * 3);
+			for(size_t i = 0; i < triangle_count * 3; ++i) ++adjacency_start[indices[i] + 1];
+			for(size_t v = 0; v < vertex_count; ++v) adjacency_start[v + 1] += adjacency_start[v];
+			{
+				auto fill = adjacency_start;
+				for(size_t i = 0; i < triangle_count * 3; ++i) adjacency[fill[indices[i]]++] = i / 3;
+			}
+			std::vector<glm::vec3> normals(triangle_count);
+			for(size_t t = 0; t < triangle_count; ++t) {
+				const glm::vec3 &a = vertices[indices[3 * t]].pos, &b = vertices[indices[3 * t + 1]].pos, &c = vertices[indices[3 * t + 2]].pos;
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float length = glm::length(normal);
+				normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+			}
+
+			constexpr uint32_t none = UINT32_MAX;
+			std::vector<uint32_t> used_by(vertex_count, none); /* meshlet that has the vertex. */
+			std::vector<bool> emitted(triangle_count, false);
+			std::vector<uint32_t> order, used; /* triangles in meshlet order, vertices of the current meshlet. */
+			order.reserve(triangle_count);
+			std::vector<meshlet> meshlets;
+			size_t cursor = 0, first = 0;
+			glm::vec3 axis { 0.0f }, lo { 0.0f }, hi { 0.0f };
+			auto centroid = [&](uint32_t t) {
+				return (vertices[indices[3 * t]].pos + vertices[indices[3 * t + 1]].pos + vertices[indices[3 * t + 2]].pos) / 3.0f;
+			};
+
+			auto extra_vertices = [&](uint32_t t) {
+				size_t extra = 0;
+				for(size_t k = 0; k < 3; ++k) extra += used_by[indices[3 * t + k]] != meshlets.size();
+				return extra;
+			};
+			auto add = [&](uint32_t t) {
+				for(size_t k = 0; k < 3; ++k) {
+					uint32_t v = indices[3 * t + k];
+					if(used_by[v] != meshlets.size()) {
+						used_by[v] = meshlets.size();
+						lo = used.empty() ? vertices[v].pos : glm::min(lo, vertices[v].pos);
+						hi = used.empty() ? vertices[v].pos : glm::max(hi, vertices[v].pos);
+						used.push_back(v);
+					}
+				}
+				emitted[t] = true;
+				order.push_back(t);
+				axis += normals[t];
+			};
+			auto close = [&] {
+				meshlets.push_back({ .first_index = uint32_t(first * 3), .index_count = uint32_t((order.size() - first) * 3) });
+				first = order.size();
+				used.clear();
+				axis = glm::vec3(0.0f);
+			};
+
+			while(order.size() < triangle_count) {
+				if(used.empty()) {
+					while(emitted[cursor]) ++cursor;
+					add(cursor);
+					continue;
+				}
+				uint32_t best = none;
+				size_t best_extra = 3;
+				float best_dot = -INFINITY;
+				if(order.size() - first < max_triangles) {
+					for(uint32_t v : used) {
+						for(uint32_t a = adjacency_start[v]; a < adjacency_start[v + 1]; ++a) {
+							uint32_t t = adjacency[a];
+							if(emitted[t]) continue;
+							size_t extra = extra_vertices(t);
+							if(used.size() + extra > max_vertices) continue;
+							float dot = glm::dot(normals[t], axis);
+							if(extra < best_extra || (extra == best_extra && dot > best_dot)) {
+								best = t;
+								best_extra = extra;
+								best_dot = dot;
+							}
+						}
+					}
+				}
+				if(best == none && order.size() - first < max_triangles && used.size() + 3 <= max_vertices) {
+					glm::vec3 center = (lo + hi) * 0.5f;
+					float best_distance = glm::length(hi - lo); /* twice the bounding box. */
+					while(emitted[cursor]) ++cursor;
+					for(size_t t = cursor, seen = 0; t < triangle_count && seen < nearby_window; ++t) {
+						if(emitted[t]) continue;
+						++seen;
+						float distance = glm::distance(centroid(t), center);
+						if(distance < best_distance) {
+							best = t;
+							best_distance = distance;
+						}
+					}
+				}
+				if(best == none) close();
+				else add(best);
+			}
+			if(!used.empty()) close();
+
+			std::vector<uint32_t> reordered, local(vertex_count), local_in(vertex_count, none), global, clusters;
+			reordered.reserve(triangle_count * 3);
+			for(uint32_t id = 0; id < meshlets.size(); ++id) {
+				const auto &m = meshlets[id];
+				// tipsify on the meshlet's own vertices, to keep it cheap.
+				std::vector<uint32_t> triangles;
+				global.clear();
+				for(size_t i = m.first_index / 3; i < (m.first_index + m.index_count) / 3; ++i) {
+					for(size_t k = 0; k < 3; ++k) {
+						uint32_t v = indices[3 * order[i] + k];
+						if(local_in[v] != id) {
+							local_in[v] = id;
+							local[v] = global.size();
+							global.push_back(v);
+						}
+						triangles.push_back(local[v]);
+					}
+				}
+				for(uint32_t v : ::gfx::vcache::tipsify(triangles, global.size(), clusters))
+					reordered.push_back(global[v]);
+			}
+			std::ranges::copy(reordered, indices.begin());
+			for(auto &m : meshlets)
+				compute_bounds<V>(m, vertices, std::span<const uint32_t>(indices).subspan(m.first_index, m.index_count));
+			return meshlets;
+		}
+	}
+
+	/* how vertex attributes are stored in a vertex buffer. positions can be
+	 * 16-bit unorm relative to the mesh bounds, normals octahedral in the xy of
+	 * a snorm 10:10:10:2 and texcoords half floats, which halves the vertex size.
+	 * vertex shaders decode them with the uniforms at the explicit locations
+	 * below (see data/shaders/default/vert.glsl). */
+	struct vertex_format {
+		enum class position_type : uint8_t { float3, unorm16 };
+		enum class normal_type : uint8_t { float3, octahedral };
+		enum class texcoord_type : uint8_t { float2, half2 };
+
+		position_type position = position_type::float3;
+		normal_type normal = normal_type::float3;
+		texcoord_type texcoord = texcoord_type::float2;
+
+		static constexpr GLint position_scale_location = 16;
+		static constexpr GLint position_offset_location = 17;
+		static constexpr GLint octahedral_normal_location = 18;
+
+		static constexpr vertex_format full() { return {}; }
+		static constexpr vertex_format compact() {
+			return { position_type::unorm16, normal_type::octahedral, texcoord_type::half2 };
+		}
+
+		constexpr uint32_t position_size() const { return position == position_type::float3 ? 12 : 8; }
+		constexpr uint32_t normal_size() const { return normal == normal_type::float3 ? 12 : 4; }
+		constexpr uint32_t texcoord_size() const { return texcoord == texcoord_type::float2 ? 8 : 4; }
+
+		constexpr uint32_t position_offset() const { return 0; }
+		constexpr uint32_t normal_offset() const { return position_size(); }
+		constexpr uint32_t texcoord_offset() const { return normal_offset() + normal_size(); }
+		constexpr uint32_t stride() const { return texcoord_offset() + texcoord_size(); }
+
+		constexpr uint32_t to_bits() const { return uint32_t(position) | uint32_t(normal) << 8 | uint32_t(texcoord) << 16; }
+		static constexpr vertex_format from_bits(uint32_t bits) {
+			return { position_type(bits & 0xff), normal_type(bits >> 8 & 0xff), texcoord_type(bits >> 16 & 0xff) };
+		}
+
+		constexpr bool operator==(const vertex_format &) const = default;
+
+		static uint16_t to_half(float f) {
+			uint32_t x = std::bit_cast<uint32_t>(f);
+			uint16_t sign = (x >> 16) & 0x8000;
+			uint32_t bits = x & 0x7fffffff;
+			if(bits >= 0x7f800000) return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0); // inf and nan.
+			if(bits >= 0x477ff000) return sign | 0x7c00; // rounds to more than the largest half.
+			if(bits < 0x38800000) return sign | uint16_t(std::lrint(std::bit_cast<float>(bits) * 16777216.0f)); // subnormal.
+			// rebias the exponent from 127 to 15 and round to nearest even.
+			bits += 0xc8000fff + ((bits >> 13) & 1);
+			return sign | uint16_t(bits >> 13);
+		}
+
+		/* unit vector to the octahedron unfolded onto [-1, 1]^2. */
+		static glm::vec2 octahedral_encode(glm::vec3 n) {
+			float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+			if(l1 == 0.0f) return {};
+			n /= l1;
+			if(n.z >= 0.0f) return { n.x, n.y };
+			return {
+				(1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+			};
+		}
+
+		static uint32_t pack_snorm_10_10_10_2(glm::vec3 v) {
+			auto snorm10 = [](float f) { return uint32_t(int32_t(std::round(std::clamp(f, -1.0f, 1.0f) * 511.0f))) & 0x3ff; };
+			return snorm10(v.x) | snorm10(v.y) << 10 | snorm10(v.z) << 20;
+		}
+
+		/* point the position, normal and texcoord attributes of `vao` at `vbo`.
+		 * every attribute gets its own binding, so they can come from anywhere
+		 * in it. a zero stride leaves the attribute disabled. */
+		void set_attributes(GLuint vao, GLuint vbo, const std::array<uint32_t, 3> &offsets, const std::array<uint32_t, 3> &strides) const {
+			struct attribute_format { GLint size; GLenum type; GLboolean normalized; };
+			const attribute_format attributes[3] {
+				position == position_type::float3
+					? attribute_format { 3, GL_FLOAT, GL_FALSE } : attribute_format { 3, GL_UNSIGNED_SHORT, GL_TRUE },
+				normal == normal_type::float3
+					? attribute_format { 3, GL_FLOAT, GL_FALSE } : attribute_format { 4, GL_INT_2_10_10_10_REV, GL_TRUE },
+				texcoord == texcoord_type::float2
+					? attribute_format { 2, GL_FLOAT, GL_FALSE } : attribute_format { 2, GL_HALF_FLOAT, GL_FALSE },
+			};
+			for(GLuint i = 0; i < 3; ++i) {
+				if(strides[i] == 0) continue;
+				glVertexArrayVertexBuffer(vao, i, vbo, offsets[i], strides[i]);
+				glVertexArrayAttribFormat(vao, i, attributes[i].size, attributes[i].type, attributes[i].normalized, 0);
+				glVertexArrayAttribBinding(vao, i, i);
+				glEnableVertexArrayAttrib(vao, i);
+			}
+		}
+
+		/* interleaved, as laid out by the offsets above. */
+		void set_attributes(GLuint vao, GLuint vbo) const {
+			set_attributes(vao, vbo, { position_offset(), normal_offset(), texcoord_offset() }, { stride(), stride(), stride() });
+		}
+	};
+
+	/* one vertex buffer, one index buffer and one vertex array shared by the
+	 * meshes of a vertex format. meshes are ranges of them, so switching
+	 * between them needs no rebinding. indices of both sizes share the index
+	 * buffer. the buffers are grown by copying into bigger ones when full. */
+	class geometry_pool {
+		::gfx::vertex_format format_;
+		GLuint vao_ = 0, vbo_ = 0, ebo_ = 0;
+		::util::range_allocator vertices_; /* in vertices. */
+		::util::range_allocator indices_; /* in bytes. */
+
+		static inline std::unordered_map<uint32_t, std::unique_ptr<geometry_pool>> pools_; /* by format bits. */
+
+		/* move the contents of `buffer` into one that fits `needed` more units. */
+		static void grow_(GLuint &buffer, ::util::range_allocator &allocator, size_t needed, size_t unit_size, size_t initial) {
+			size_t capacity = std::max({ initial, allocator.capacity() * 2, allocator.capacity() + needed });
+			GLuint bigger;
+			glCreateBuffers(1, &bigger);
+			glNamedBufferStorage(bigger, capacity * unit_size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			if(buffer != 0) {
+				glCopyNamedBufferSubData(buffer, bigger, 0, 0, allocator.capacity() * unit_size);
+				glDeleteBuffers(1, &buffer);
+			}
+			buffer = bigger;
+			allocator.grow(capacity);
+		}
+	public:
+		static inline size_t initial_vertices = size_t(1) << 16;
+		static inline size_t initial_index_bytes = size_t(1) << 20;
+
+		/* in vertices or index bytes, as returned by `add_vertices` and `add_indices`. */
+		struct range {
+			size_t offset = 0, size = 0;
+		};
+
+		explicit geometry_pool(const ::gfx::vertex_format &format) : format_(format) {
+			glCreateVertexArrays(1, &vao_);
+		}
+
+		geometry_pool(const geometry_pool &) = delete;
+		geometry_pool &operator=(const geometry_pool &) = delete;
+
+		~geometry_pool() {
+			glDeleteBuffers(1, &ebo_);
+			glDeleteBuffers(1, &vbo_);
+			glDeleteVertexArrays(1, &vao_);
+		}
+
+		/* the pool for `format`, created on first use. */
+		static ::gfx::geometry_pool &of(const ::gfx::vertex_format &format) {
+			auto &pool = pools_[format.to_bits()];
+			if(!pool) pool = std::make_unique<geometry_pool>(format);
+			return *pool;
+		}
+
+		/* delete all pools, while there still is a gl context. */
+		static void delete_all() { pools_.clear(); }
+
+		static void print_stats() {
+			for(const auto &[bits, pool] : pools_) {
+				clog.println("geometry pool {:#x}: {}/{} vertices, {}/{} index bytes", bits,
+					pool->vertices_.used(), pool->vertices_.capacity(), pool->indices_.used(), pool->indices_.capacity());
+			}
+		}
+
+		GLuint vao() const { return vao_; }
+		const ::gfx::vertex_format &format() const { return format_; }
+
+		/* copy in interleaved vertices of the pool's format. */
+		range add_vertices(std::span<const std::byte> bytes) {
+			size_t stride = format_.stride(), count = bytes.size() / stride;
+			if(count == 0) return {};
+			auto offset = vertices_.allocate(count);
+			if(!offset) {
+				grow_(vbo_, vertices_, count, stride, initial_vertices);
+				format_.set_attributes(vao_, vbo_);
+				offset = vertices_.allocate(count);
+			}
+			glNamedBufferSubData(vbo_, *offset * stride, count * stride, bytes.data());
+			return { *offset, count };
+		}
+
+		/* copy in 2 or 4 byte indices. the range is aligned for both. */
+		range add_indices(std::span<const std::byte> bytes) {
+			if(bytes.empty()) return {};
+			auto offset = indices_.allocate(bytes.size(), 4);
+			if(!offset) {
+				grow_(ebo_, indices_, bytes.size() + 3, 1, initial_index_bytes);
+				glVertexArrayElementBuffer(vao_, ebo_);
+				offset = indices_.allocate(bytes.size(), 4);
+			}
+			glNamedBufferSubData(ebo_, *offset, bytes.size(), bytes.data());
+			return { *offset, bytes.size() };
+		}
+
+		void free_vertices(const range &r) { if(r.size != 0) vertices_.free(r.offset, r.size); }
+		void free_indices(const range &r) { if(r.size != 0) indices_.free(r.offset, r.size); }
+	};
+
+	class shader {
+	public:
+		/* index of a uniform in `uniforms()`, negative if the program has none by that name. */
+		using slot_type = int32_t;
+
+		/* an active uniform, block or vertex attribute of the linked program.
+		 * arrays are named without their "[0]". */
+		struct resource_info {
+			::util::string_id name;
+			GLint location; /* the binding of blocks. */
+			GLenum type; /* GL_UNIFORM_BLOCK or GL_SHADER_STORAGE_BLOCK for blocks. */
+			GLint size; /* array length, the data size in bytes for blocks. */
+		};
+	private:
+		friend ::gfx::renderer;
+		GLuint id;
+		/* reflected after linking, see `reflect_`. uniforms inside blocks are left out. */
+		std::vector<resource_info> uniforms_, blocks_, attributes_;
+		bool decodes_vertex_format = false; /* has the uniforms of gfx::vertex_format. */
+		bool draws_indirect = false; /* reads its transform from the draw data of gfx::renderer::flush. */
+
+		static bool is_sampler_(GLenum type) {
+			switch(type) {
+			case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+			case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY:
+			case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER:
+			case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+			case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+			case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE: case GL_INT_SAMPLER_2D_ARRAY:
+			case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+			case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/* list the active resources of `interface`, calling `f(index, values)`
+		 * with the `props` of each, and its name (GL_NAME_LENGTH comes first). */
+		template<size_t N, typename F>
+		void list_resources_(GLenum interface, const std::array<GLenum, N> &props, F &&f) {
+			GLint count = 0;
+			glGetProgramInterfaceiv(id, interface, GL_ACTIVE_RESOURCES, &count);
+			std::string name;
+			for(GLint i = 0; i < count; ++i) {
+				std::array<GLint, N> values {};
+				glGetProgramResourceiv(id, interface, i, N, props.data(), N, nullptr, values.data());
+				name.resize(std::max(values[0], 1));
+				glGetProgramResourceName(id, interface, i, name.size(), nullptr, name.data());
+				name.resize(name.size() - 1);
+				if(name.ends_with("[0]")) name.resize(name.size() - 3);
+				f(strv(name), values);
+			}
+		}
+
+		/* fill the tables of uniforms, blocks and attributes from the linked program. */
+		void reflect_() {
+			uniforms_.clear();
+			blocks_.clear();
+			attributes_.clear();
+			list_resources_(GL_UNIFORM, std::array<GLenum, 5> { GL_NAME_LENGTH, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE, GL_BLOCK_INDEX },
+				[&](strv name, const auto &v) {
+					if(v[4] != -1) return; // in a uniform block, so it has no location.
+					uniforms_.push_back({ ::util::string_id::intern(name), v[1], GLenum(v[2]), v[3] });
+				});
+			for(GLenum interface : { GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK }) {
+				list_resources_(interface, std::array<GLenum, 3> { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE },
+					[&](strv name, const auto &v) {
+						blocks_.push_back({ ::util::string_id::intern(name), v[1], interface, v[2] });
+					});
+			}
+			list_resources_(GL_PROGRAM_INPUT, std::array<GLenum, 4> { GL_NAME_LENGTH, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE },
+				[&](strv name, const auto &v) {
+					if(name.starts_with("gl_")) return;
+					attributes_.push_back({ ::util::string_id::intern(name), v[1], GLenum(v[2]), v[3] });
+				});
+			clog.println("uniforms: {} ({} samplers), blocks: {}, attributes: {}", uniforms_.size(),
+				std::ranges::count_if(uniforms_, [](const auto &u) { return is_sampler_(u.type); }),
+				blocks_.size(), attributes_.size());
+
+			auto location_of = [&](::util::string_id name) {
+				slot_type slot = uniform_slot(name);
+				return slot < 0 ? -1 : uniforms_[slot].location;
+			};
+			decodes_vertex_format = location_of("uPositionScale"_sid) == ::gfx::vertex_format::position_scale_location;
+			draws_indirect = location_of("uDrawBase"_sid) == draw_base_location;
+		}
+
+		GLint location_(slot_type slot) const { return slot < 0 ? -1 : uniforms_[slot].location; }
+	public:
+		/* first draw data of a multi draw, a negative one for uniforms instead. */
+		static constexpr GLint draw_base_location = 19;
+		static constexpr GLuint draw_data_binding = 0;
+		/* model matrices of `gfx::renderer::render_instanced`. */
+		static constexpr GLuint instance_binding = 1;
+		/* uniform blocks written by `gfx::renderer` each frame, and for each object. */
+		static constexpr GLuint frame_binding = 0;
+		static constexpr GLuint object_binding = 1;
+
+		void unload(::res::res_manager &m, const ::res::res_id_type &rid) {
+			glDeleteProgram(id);
+		}
+
+		struct staging_type {
+			std::vector<char> vs_content, fs_content; /* null-terminated sources. */
+		};
+
+		static staging_type stage_from_file(const stdfs::path &general_path) {
+			staging_type staging;
+			staging.vs_content = ::util::read_file(general_path / "vert.glsl");
+			staging.vs_content.push_back('\0');
+			staging.fs_content = ::util::read_file(general_path / "frag.glsl");
+			staging.fs_content.push_back('\0');
+			return staging;
+		}
+
+		void load_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &general_path) {
+			load_from_staging(m, rid, general_path, stage_from_file(general_path));
+		}
+
+		/* compile and link into a new program, keeping the old one if that
+		 * fails, so that a typo in a watched shader doesn't end the program. */
+		bool reload_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &general_path) {
+			GLuint program;
+			try {
+				::util::recoverable_failures recoverable;
+				auto staging = stage_from_file(general_path);
+				program = build_program_(staging);
+			} catch(const ::util::failure &) {
+				return false;
+			} catch(const std::exception &e) {
+				::util::print_error("Failed to reload shader {}: {}", general_path, e.what());
+				return false;
+			}
+			glDeleteProgram(id);
+			id = program;
+			reflect_();
+			return true;
+		}
+
+		void load_from_staging(
+			::res::res_manager &m,
+			const ::res::res_id_type &rid,
+			const stdfs::path &general_path,
+			staging_type &&staging
+		) {
+			clog.println("path: {}", general_path);
+			clog.println("vs path: {}", general_path / "vert.glsl");
+			clog.println("fs path: {}", general_path / "frag.glsl");
+			id = build_program_(staging);
+			reflect_();
+		}
+
+	private:
+		static GLuint compile_(GLenum type, const std::vector<char> &source, strv kind) {
+			auto shader = glCreateShader(type);
+			const char *data = source.data();
+			glShaderSource(shader, 1, &data, nullptr);
+			glCompileShader(shader);
+
+			GLint success = GL_FALSE;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+			if(!success) {
+				GLchar message[1024];
+				glGetShaderInfoLog(shader, 1024, nullptr, message);
+				glDeleteShader(shader);
+				::util::fail_error("Failed to compile {} shader:\n{}", kind, message);
+			}
+			return shader;
+		}
+
+		/* the linked program, fails (see `util::fail`) on compile or link errors. */
+		static GLuint build_program_(const staging_type &staging) {
+			auto vs = compile_(GL_VERTEX_SHADER, staging.vs_content, "vertex");
+			GLuint fs;
+			try {
+				fs = compile_(GL_FRAGMENT_SHADER, staging.fs_content, "fragment");
+			} catch(...) {
+				glDeleteShader(vs);
+				throw;
+			}
+
+			auto program = glCreateProgram();
+			glAttachShader(program, fs);
+			glAttachShader(program, vs);
+			glLinkProgram(program);
+			glDeleteShader(fs); // freed along with the program.
+			glDeleteShader(vs);
+			GLint success = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			if(success != GL_TRUE) {
+				GLsizei log_length = 0;
+				GLchar message[1024];
+				glGetProgramInfoLog(program, 1024, &log_length, message);
+				glDeleteProgram(program);
+				::util::fail_error("Failed to link shader program:\n{}", message);
+			}
+			return program;
+		}
+	public:
+		std::span<const resource_info> uniforms() const { return uniforms_; }
+		std::span<const resource_info> blocks() const { return blocks_; }
+		std::span<const resource_info> attributes() const { return attributes_; }
+
+		/* search the uniform table, resolve names once and keep the slot. */
+		slot_type uniform_slot(::util::string_id name) const {
+			for(size_t i = 0; i < uniforms_.size(); ++i)
+				if(uniforms_[i].name == name) return slot_type(i);
+			return -1;
+		}
+
+		void set_uniform(slot_type slot, int v) const {
+			glProgramUniform1i(id, location_(slot), v);
+		}
+
+		void set_uniform(slot_type slot, float v) const {
+			glProgramUniform1f(id, location_(slot), v);
+		}
+
+		void set_uniform(slot_type slot, glm::vec2 v) const {
+			glProgramUniform2f(id, location_(slot),
+				v.x, v.y);
+		}
+
+		void set_uniform(slot_type slot, glm::vec3 v) const {
+			glProgramUniform3f(id, location_(slot),
+				v.x, v.y, v.z);
+		}
+
+		void set_uniform(slot_type slot, glm::vec4 v) const {
+			glProgramUniform4f(id, location_(slot),
+				v.x, v.y, v.z, v.w);
+		}
+
+		void set_uniform(slot_type slot, const glm::mat4 &v) const {
+			glProgramUniformMatrix4fv(id, location_(slot),
+				1, GL_FALSE, glm::value_ptr(v));
+		}
+
+		template<typename T>
+		void set_uniform(::util::string_id name, const T &v) const {
+			set_uniform(uniform_slot(name), v);
+		}
+
+		template<typename T>
+		void set_uniform(strv name, const T &v) const {
+			set_uniform(::util::string_id::of(name), v);
+		}
+	};
+
+	class texture {
+		friend ::gfx::renderer;
+		GLuint id;
+		glm::ivec2 size;
+		GLsizei levels;
+
+		static glm::ivec2 level_size_(glm::ivec2 size, int level) {
+			return { std::max(1, size.x >> level), std::max(1, size.y >> level) };
+		}
+	public:
+		void unload(::res::res_manager &m, const ::res::res_id_type &rid) {
+			glDeleteTextures(1, &id);
+		}
+
+		struct staging_type {
+			glm::ivec2 size;
+			std::shared_ptr<uint8_t> pixels; /* rgba8 decoded by stb, null if decoding failed. */
+			std::shared_ptr<const ::util::mapped_file> mapping; /* cooked file, if loaded from one. */
+			std::vector<std::span<const std::byte>> levels; /* mip chain in `mapping`. */
+		};
+
+		static staging_type stage_from_file(const stdfs::path &path) {
+			if(auto cooked = ::gfx::cooked::find(path, ::gfx::cooked::texture_magic); !cooked.empty())
+				return stage_from_cooked(cooked);
+			return stage_from_source(path);
+		}
+
+		/* decode an image file with stb. */
+		static staging_type stage_from_source(const stdfs::path &path) {
+			staging_type staging;
+			int channels;
+			::util::bytes_read += stdfs::file_size(path);
+			uint8_t *pixels = stbi_load(path.c_str(), &staging.size.x, &staging.size.y, &channels, 4);
+			staging.pixels = std::shared_ptr<uint8_t>(pixels, stbi_image_free);
+			return staging;
+		}
+
+		static staging_type stage_from_cooked(const stdfs::path &path) {
+			staging_type staging;
+			staging.mapping = std::make_shared<const ::util::mapped_file>(path, true);
+			auto bytes = staging.mapping->bytes();
+			if(bytes.size() < sizeof(::gfx::cooked::texture_header))
+				::util::fail_error("Truncated cooked texture: {}", path);
+			const auto *header = (const ::gfx::cooked::texture_header*)bytes.data();
+			if(header->version != ::gfx::cooked::version || header->internal_format != GL_RGBA8
+			|| header->format != GL_RGBA || header->type != GL_UNSIGNED_BYTE)
+				::util::fail_error("Unsupported cooked texture: {}", path);
+			staging.size = glm::ivec2(int(header->width), int(header->height));
+			size_t offset = sizeof(*header);
+			for(uint32_t i = 0; i < header->levels; ++i) {
+				size_t level_size = level_size_(staging.size, i).x * level_size_(staging.size, i).y * 4;
+				if(offset + level_size > bytes.size())
+					::util::fail_error("Truncated cooked texture: {}", path);
+				staging.levels.push_back(bytes.subspan(offset, level_size));
+				offset += level_size;
+			}
+			return staging;
+		}
+
+		/* write the cooked version of an image: rgba8 with a full box-filtered mip chain. */
+		static void cook(const stdfs::path &source, const stdfs::path &output) {
+			auto staging = stage_from_source(source);
+			if(!staging.pixels) ::util::fail_error("Failed to load image: {}", source);
+
+			std::vector<std::vector<uint8_t>> chain;
+			chain.emplace_back(staging.pixels.get(), staging.pixels.get() + staging.size.x * staging.size.y * 4);
+			for(uint32_t i = 1; level_size_(staging.size, i - 1) != glm::ivec2(1, 1); ++i) {
+				auto src_size = level_size_(staging.size, i - 1);
+				auto dst_size = level_size_(staging.size, i);
+				const auto &src = chain.back();
+				std::vector<uint8_t> dst(dst_size.x * dst_size.y * 4);
+				for(int y = 0; y < dst_size.y; ++y) {
+					for(int x = 0; x < dst_size.x; ++x) {
+						int x0 = std::min(2 * x, src_size.x - 1), x1 = std::min(2 * x + 1, src_size.x - 1);
+						int y0 = std::min(2 * y, src_size.y - 1), y1 = std::min(2 * y + 1, src_size.y - 1);
+						for(int c = 0; c < 4; ++c) {
+							int sum = src[(y0 * src_size.x + x0) * 4 + c] + src[(y0 * src_size.x + x1) * 4 + c]
+							        + src[(y1 * src_size.x + x0) * 4 + c] + src[(y1 * src_size.x + x1) * 4 + c];
+							dst[(y * dst_size.x + x) * 4 + c] = (sum + 2) / 4;
+						}
+					}
+				}
+				chain.push_back(std::move(dst));
+			}
+
+			::gfx::cooked::texture_header header {
+				.version = ::gfx::cooked::version,
+				.width = uint32_t(staging.size.x), .height = uint32_t(staging.size.y),
+				.levels = uint32_t(chain.size()),
+				.internal_format = GL_RGBA8, .format = GL_RGBA, .type = GL_UNSIGNED_BYTE,
+			};
+			std::memcpy(header.magic, ::gfx::cooked::texture_magic, sizeof(header.magic));
+
+			std::vector<std::span<const std::byte>> parts { std::as_bytes(std::span(&header, 1)) };
+			for(const auto &level : chain)
+				parts.push_back(std::as_bytes(std::span(level)));
+			::gfx::cooked::write(output, parts);
+		}
+
+		void load_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &path) {
+			load_from_staging(m, rid, path, stage_from_file(path));
+		}
+
+		/* upload into a new texture and only delete the old one if that worked,
+		 * so that a half written image keeps the old version. */
+		bool reload_from_file(::res::res_manager &m, const ::res::res_id_type &rid, const stdfs::path &path) {
+			texture fresh;
+			try {
+				::util::recoverable_failures recoverable;
+				fresh.load_from_staging(m, rid, path, stage_from_file(path));
+			} catch(const ::util::failure &) {
+				return false;
+			} catch(const std::exception &e) {
+				::util::print_error("Failed to reload texture {}: {}", path, e.what());
+				return false;
+			}
+			unload(m, rid);
+			*this = fresh;
+			return true;
+		}
+
+		void load_from_staging(
+			::res::res_manager &m,
+			const ::res::res_id_type &rid,
+			const stdfs::path &path,
+			staging_type &&staging
+		) {
+			clog.println("path: {}", path);
+			if(!staging.pixels && !staging.mapping) ::util::fail_error("Failed to load image: {}", path);
+
+			size = staging.size;
+			levels = staging.mapping ? staging.levels.size() : 1;
+			glCreateTextures(GL_TEXTURE_2D, 1, &id);
+			glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+			glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+			glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+			glTextureStorage2D(id, levels, GL_RGBA8, size.x, size.y);
+			if(staging.mapping) {
+				clog.println("cooked: {} levels", levels);
+				for(GLsizei i = 0; i < levels; ++i) {
+					auto level_size = level_size_(size, i);
+					glTextureSubImage2D(id, i, 0, 0, level_size.x, level_size.y,
+						GL_RGBA, GL_UNSIGNED_BYTE, staging.levels[i].data());
+				}
+			} else {
+				glTextureSubImage2D(id, 0, 0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, staging.pixels.get());
+			}
+		}
+
+		glm::ivec2 get_size() const { return size; }
+
+		::res::res_usage get_usage() const {
+			size_t bytes = 0;
+			for(GLsizei i = 0; i < levels; ++i)
+				bytes += size_t(level_size_(size, i).x) * level_size_(size, i).y * 4;
+			return { sizeof(texture), bytes };
+		}
+	};
+
+	enum class mesh_mode {
+		triangle_strip = GL_TRIANGLE_STRIP,
+		triangle_fan = GL_TRIANGLE_FAN,
+		triangles = GL_TRIANGLES,
+	};
+
+	class mesh {
+	public:
+		/* a range of the index buffer drawn with its own base vertex, and the
+		 * meshlets it is made of. */
+		struct submesh {
+			uint32_t first_index, index_count;
+			int32_t base_vertex;
+			uint32_t first_meshlet = 0, meshlet_count = 0;
+		};
+
+		/* the submeshes drawn for a level of detail, and how far (in model space)
+		 * its surface is from the full detail one at most. */
+		struct lod_level {
+			uint32_t first_submesh, submesh_count;
+			float error;
+		};
+	private:
+		friend ::gfx::renderer;
+		bool indexed;
+		GLuint vao, vbo, ebo; /* `vbo` and `ebo` only if not in a pool. */
+		::gfx::geometry_pool *pool = nullptr;
+		::gfx::geometry_pool::range pool_vertices, pool_indices;
+		GLint first_vertex = 0; /* added to the base vertex of every draw. */
+		size_t index_offset = 0; /* in bytes, added to the offset of every draw. */
+		GLsizei vertex_count, index_count;
+		GLsizei index_size; /* 2 or 4 bytes. */
+		size_t vertex_bytes; /* size of the vertices. */
+		mesh_mode mode;
+		std::vector<submesh> submeshes;
+		std::vector<lod_level> lods; /* at least one for indexed meshes. */
+		std::vector<::gfx::cluster::meshlet> meshlets;
+		::gfx::aabb bounding_box; /* in model space. */
+		::gfx::sphere bounding_sphere;
+		::gfx::vertex_format format;
+		glm::vec3 position_scale, position_offset; /* decode of `vertex_format::position_type::unorm16`. */
+		uint32_t sort_id = 0; /* see `gfx::render_queue`. */
+		static inline uint32_t next_sort_id_ = 0;
+	public:
+		struct vertex_type {
+			glm::vec3 pos;
+			glm::vec3 norm;
+			glm::vec2 texcoord;
+
+			bool operator==(const vertex_type &other) const {
+				return pos == other.pos && norm == other.norm && texcoord == other.texcoord;
+			}
+		};
+
+		/* split triangle lists with more than 65536 vertices into submeshes that
+		 * fit 16-bit indices, instead of using 32-bit indices for the whole mesh.
+		 * this duplicates the vertices shared between submeshes. */
+		static inline bool split_large = true;
+		static constexpr size_t max_u16_vertices = size_t(UINT16_MAX) + 1;
+
+		/* simplified versions of triangle lists made by `finish_indices`, each
+		 * with about `lod_ratio` times the triangles of the previous one, down to
+		 * an error of `lod_max_error` times the bounding radius. they share the
+		 * vertices of the full detail mesh. 1 disables them. */
+		static inline size_t max_lods = 4;
+		static inline float lod_ratio = 0.5f;
+		static inline float lod_max_error = 0.1f;
+
+		/* reorder the triangles of triangle lists into meshlets the renderer can
+		 * cull one by one, see `gfx::cluster`. */
+		static inline bool build_meshlets = true;
+
+		/* vertex format meshes are packed into when they are staged or cooked. */
+		static inline ::gfx::vertex_format default_format = ::gfx::vertex_format::compact();
+
+		/* put interleaved meshes into the `gfx::geometry_pool` of their format
+		 * instead of buffers of their own. */
+		static inline bool use_geometry_pool = true;
+
+		/* packed vertices and how to decode them. the attributes don't have to be
+		 * interleaved, `bytes` is uploaded as-is and each attribute is read from
+		 * its own offset and stride in it. */
+		struct vertex_buffer_view {
+			::gfx::vertex_format format;
+			glm::vec3 position_scale { 1.0f }, position_offset { 0.0f };
+			std::span<const std::byte> bytes;
+			size_t count = 0;
+			/* of the position, normal and texcoord. a zero stride means the attribute is missing. */
+			std::array<uint32_t, 3> offsets {}, strides {};
+
+			/* vertices laid out one after the other, as `format` describes. */
+			static vertex_buffer_view interleaved(
+				const ::gfx::vertex_format &format,
+				const glm::vec3 &position_scale,
+				const glm::vec3 &position_offset,
+				std::span<const std::byte> bytes
+			) {
+				uint32_t stride = format.stride();
+				return {
+					format, position_scale, position_offset, bytes, bytes.size() / stride,
+					{ format.position_offset(), format.normal_offset(), format.texcoord_offset() },
+					{ stride, stride, stride }
+				};
+			}
+
+			bool is_interleaved() const {
+				uint32_t stride = format.stride();
+				return offsets == std::array<uint32_t, 3> { format.position_offset(), format.normal_offset(), format.texcoord_offset() }
+					&& strides == std::array<uint32_t, 3> { stride, stride, stride }
+					&& bytes.size() == count * stride;
+			}
+		};
+
+		const ::gfx::aabb &get_bounding_box() const { return bounding_box; }
+		const ::gfx::sphere &get_bounding_sphere() const { return bounding_sphere; }
+
+		::res::res_usage get_usage() const {
+			return {
+				sizeof(mesh) + submeshes.size() * sizeof(submesh) + lods.size() * sizeof(lod_level)
+					+ meshlets.size() * sizeof(::gfx::cluster::meshlet),
+				vertex_bytes + size_t(index_count) * index_size
+			};
+		}
+
+		void unload(::res::res_manager &m, const ::res::res_id_type &id) {
+			if(pool != nullptr) {
+				pool->free_vertices(pool_vertices);
+				pool->free_indices(pool_indices);
+				pool = nullptr;
+				return;
+			}
+			if(indexed) glDeleteBuffers(1, &ebo);
+			glDeleteBuffers(1, &vbo);
+			glDeleteVertexArrays(1, &vao);
+		}
+
+		struct staging_type {
+			mesh_mode mode = mesh_mode::triangles;
+			bool indexed = false;
+			std::vector<vertex_type> vertices;
+			std::vector<uint32_t> indices; /* relative to the base vertex of their submesh. */
+			std::vector<submesh> submeshes;
+			std::vector<lod_level> lods; /* empty for a single level with all submeshes. */
+			std::vector<::gfx::cluster::meshlet> meshlets;
+			::gfx::aabb bounding_box;
+			::gfx::sphere bounding_sphere;
+			uint32_t index_size = 4;
+			std::vector<std::byte> packed_indices; /* `indices` at `index_size`, see `finish_indices`. */
+			::gfx::vertex_format format;
+			glm::vec3 position_scale { 1.0f }, position_offset { 0.0f };
+			std::vector<std::byte> packed_vertices; /* `vertices` in `format`, see `pack_vertices`. */
+			/* files the buffers are uploaded from directly, cooked or .glb/.bin. */
+			std::vector<std::shared_ptr<const ::util::mapped_file>> mappings;
+			vertex_buffer_view mapped_vertices; /* in `mappings`. */
+			std::span<const std::byte> mapped_indices; /* in `mappings`. */
+			std::span<const submesh> mapped_submeshes; /* in `mappings`, or empty to use `submeshes`. */
+			std::span<const lod_level> mapped_lods; /* in `mappings`, or empty to use `lods`. */
+			std::span<const ::gfx::cluster::meshlet> mapped_meshlets; /* in `mappings`, or empty to use `meshlets`. */
+			::gfx::vcache::stats cache_before, cache_after; /* of `finish_indices`. */
+
+			bool mapped() const { return !mappings.empty(); }
+			vertex_buffer_view vertex_data() const {
+				if(mapped()) return mapped_vertices;
+				return vertex_buffer_view::interleaved(format, position_scale, position_offset, std::as_bytes(std::span(packed_vertices)));
+			}
+			std::span<const std::byte> index_data() const { return mapped() ? mapped_indices : std::as_bytes(std::span(packed_indices)); }
+			std::span<const submesh> submesh_data() const { return mapped_submeshes.empty() ? std::span(submeshes) : mapped_submeshes; }
+			std::span<const lod_level> lod_data() const { return mapped_lods.empty() ? std::span(lods) : mapped_lods; }
+			std::span<const ::gfx::cluster::meshlet> meshlet_data() const { return mapped_meshlets.empty() ? std::span(meshlets) : mapped_meshlets; }
+		};
+
+		/* split large meshes if `split_large` allows it, optimize the vertex and
+		 * triangle order of triangle lists, add their lods and meshlets, then
+		 * pack `staging.indices` with the narrowest index size that fits. */
+		static void finish_indices(staging_type &staging) {
+			if(!staging.indexed) return;
+			if(split_large && staging.mode == mesh_mode::triangles && staging.vertices.size() > max_u16_vertices)
+				split_u16_(staging);
+			if(staging.submeshes.empty())
+				staging.submeshes.push_back({ 0, uint32_t(staging.indices.size()), 0 });
+
+			if(staging.mode == mesh_mode::triangles) {
+				staging.cache_before = staging.cache_after = {};
+				for(size_t i = 0; i < staging.submeshes.size(); ++i) {
+					const auto &sub = staging.submeshes[i];
+					size_t vertex_end = i + 1 < staging.submeshes.size() ? staging.submeshes[i + 1].base_vertex : staging.vertices.size();
+					auto [before, after] = ::gfx::vcache::optimize<vertex_type>(
+						std::span(staging.vertices).subspan(sub.base_vertex, vertex_end - sub.base_vertex),
+						std::span(staging.indices).subspan(sub.first_index, sub.index_count));
+					staging.cache_before += before;
+					staging.cache_after += after;
+				}
+				add_lods_(staging);
+				if(build_meshlets) {
+					add_meshlets_(staging);
+					// meshlets change the triangle order of the full detail mesh again.
+					staging.cache_after = {};
+					for(size_t i = 0; i < staging.lods[0].submesh_count; ++i) {
+						const auto &sub = staging.submeshes[i];
+						staging.cache_after += ::gfx::vcache::analyze(
+							std::span(staging.indices).subspan(sub.first_index, sub.index_count), vertex_count_of_(staging, sub));
+					}
+				}
+			}
+
+			bool narrow = true;
+			for(const auto &sub : staging.submeshes) {
+				auto range = std::span(staging.indices).subspan(sub.first_index, sub.index_count);
+				if(!range.empty() && std::ranges::max(range) > UINT16_MAX) narrow = false;
+			}
+			staging.index_size = narrow ? 2 : 4;
+			staging.packed_indices.resize(staging.indices.size() * staging.index_size);
+			if(narrow) {
+				auto *out = (uint16_t*)staging.packed_indices.data();
+				for(size_t i = 0; i < staging.indices.size(); ++i) out[i] = staging.indices[i];
+			} else {
+				std::memcpy(staging.packed_indices.data(), staging.indices.data(), staging.packed_indices.size());
+			}
+		}
+
+		/* pack `staging.vertices` into `format` and compute their bounds.
+		 * quantized positions are relative to the bounding box. */
+		static void pack_vertices(staging_type &staging, ::gfx::vertex_format format = default_format) {
+			using ::gfx::vertex_format;
+			staging.format = format;
+			staging.position_scale = glm::vec3(1.0f);
+			staging.position_offset = glm::vec3(0.0f);
+			std::tie(staging.bounding_box, staging.bounding_sphere) = bounds_of_(staging.vertices);
+			if(format.position == vertex_format::position_type::unorm16 && !staging.vertices.empty()) {
+				staging.position_offset = staging.bounding_box.lo;
+				staging.position_scale = staging.bounding_box.hi - staging.bounding_box.lo;
+			}
+
+			size_t stride = format.stride();
+			staging.packed_vertices.resize(staging.vertices.size() * stride);
+			for(size_t i = 0; i < staging.vertices.size(); ++i) {
+				const auto &v = staging.vertices[i];
+				std::byte *out = staging.packed_vertices.data() + i * stride;
+				if(format.position == vertex_format::position_type::float3) {
+					std::memcpy(out + format.position_offset(), &v.pos, sizeof(v.pos));
+				} else {
+					uint16_t q[4] {};
+					for(int c = 0; c < 3; ++c) {
+						float extent = staging.position_scale[c];
+						float t = extent > 0.0f ? (v.pos[c] - staging.position_offset[c]) / extent : 0.0f;
+						q[c] = uint16_t(std::round(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+					}
+					std::memcpy(out + format.position_offset(), q, sizeof(q));
+				}
+				if(format.normal == vertex_format::normal_type::float3) {
+					std::memcpy(out + format.normal_offset(), &v.norm, sizeof(v.norm));
+				} else {
+					auto octahedral = vertex_format::octahedral_encode(v.norm);
+					uint32_t packed = vertex_format::pack_snorm_10_10_10_2({ octahedral.x, octahedral.y, 0.0f });
+					std::memcpy(out + format.normal_offset(), &packed, sizeof(packed));
+				}
+				if(format.texcoord == vertex_format::texcoord_type::float2) {
+					std::memcpy(out + format.texcoord_offset(), &v.texcoord, sizeof(v.texcoord));
+				} else {
+					uint16_t h[2] { vertex_format::to_half(v.texcoord.x), vertex_format::to_half(v.texcoord.y) };
+					std::memcpy(out + format.texcoord_offset(), h, sizeof(h));
+				}
+			}
+		}
+
+		static staging_type stage_from_file(const stdfs::path &path) {
+			if(auto cooked = ::gfx::cooked::find(path, ::gfx::cooked::mesh_magic); !cooked.empty())
+				return stage_from_cooked(cooked);
+			return stage_from_source(path);
+		}
+
+		/* parse and deduplicate an .obj, .gltf or .glb file. `zero_copy` allows
+		 * gltf buffers to be uploaded as they are stored, see `stage_from_gltf`. */
+		static staging_type stage_from_source(const stdfs::path &path, bool zero_copy = true) {
+			if(path.extension() == ".gltf" || path.extension() == ".glb") {
+				return stage_from_gltf(path.c_str(), zero_copy);
+			} else if(path.extension() == ".obj") {
+				return stage_from_obj(path.c_str());
 			} else {
 				::util::fail_error("Unknown file extension: {}", path.extension());
 			}
+			return {};
+		}
+
+		void load_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
+			load_from_staging(m, id, path, stage_from_file(path));
+		}
+
+		/* upload into a new mesh and only free the old buffers or pool ranges
+		 * once that worked, so that a broken model file keeps the old version. */
+		bool reload_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
+			mesh fresh;
+			try {
+				::util::recoverable_failures recoverable;
+				fresh.load_from_staging(m, id, path, stage_from_file(path));
+			} catch(const ::util::failure &) {
+				return false;
+			} catch(const std::exception &e) {
+				::util::print_error("Failed to reload mesh {}: {}", path, e.what());
+				return false;
+			}
+			unload(m, id);
+			*this = std::move(fresh);
+			return true;
+		}
+
+		void load_from_staging(
+			::res::res_manager &m,
+			const ::res::res_id_type &id,
+			const stdfs::path &path,
+			staging_type &&staging
+		) {
+			clog.println("path: {}", path);
+			if(staging.mapped()) clog.println("mapped: yes ({} files)", staging.mappings.size());
+			if(staging.cache_after.triangles > 0) {
+				clog.println("acmr: {:.3f} -> {:.3f}, atvr: {:.3f} -> {:.3f}",
+					staging.cache_before.acmr(), staging.cache_after.acmr(),
+					staging.cache_before.atvr(), staging.cache_after.atvr());
+			}
+			if(staging.indexed) {
+				load_from_data(staging.mode, staging.vertex_data(), staging.index_data(),
+					staging.index_size, staging.submesh_data(), staging.lod_data(), staging.meshlet_data());
+			} else {
+				load_from_data(staging.mode, staging.vertex_data());
+			}
+			bounding_box = staging.bounding_box;
+			bounding_sphere = staging.bounding_sphere;
+		}
+
+		static staging_type stage_from_cooked(const stdfs::path &path) {
+			staging_type staging;
+			staging.mappings.push_back(std::make_shared<const ::util::mapped_file>(path, true));
+			auto bytes = staging.mappings[0]->bytes();
+			if(bytes.size() < sizeof(::gfx::cooked::mesh_header))
+				::util::fail_error("Truncated cooked mesh: {}", path);
+			const auto *header = (const ::gfx::cooked::mesh_header*)bytes.data();
+			auto format = ::gfx::vertex_format::from_bits(header->vertex_format);
+			if(header->version != ::gfx::cooked::version || header->vertex_size != format.stride()
+			|| (header->index_size != 2 && header->index_size != 4))
+				::util::fail_error("Unsupported cooked mesh: {}", path);
+			size_t submeshes_size = size_t(header->submesh_count) * sizeof(submesh);
+			size_t lods_size = size_t(header->lod_count) * sizeof(lod_level);
+			size_t meshlets_size = size_t(header->meshlet_count) * sizeof(::gfx::cluster::meshlet);
+			size_t vertices_size = size_t(header->vertex_count) * format.stride();
+			size_t indices_size = size_t(header->index_count) * header->index_size;
+			if(sizeof(*header) + submeshes_size + lods_size + meshlets_size + vertices_size + indices_size > bytes.size())
+				::util::fail_error("Truncated cooked mesh: {}", path);
+			staging.mode = (mesh_mode)header->mode;
+			staging.indexed = header->indexed;
+			staging.index_size = header->index_size;
+			staging.format = format;
+			std::memcpy(&staging.position_scale, header->position_scale, sizeof(header->position_scale));
+			std::memcpy(&staging.position_offset, header->position_offset, sizeof(header->position_offset));
+			std::memcpy(&staging.bounding_sphere, header->bounding_sphere, sizeof(header->bounding_sphere));
+			std::memcpy(&staging.bounding_box, header->bounding_box, sizeof(header->bounding_box));
+			const auto *data = bytes.data() + sizeof(*header);
+			staging.mapped_submeshes = { (const submesh*)data, header->submesh_count };
+			staging.mapped_lods = { (const lod_level*)(data + submeshes_size), header->lod_count };
+			staging.mapped_meshlets = { (const ::gfx::cluster::meshlet*)(data + submeshes_size + lods_size), header->meshlet_count };
+			data += lods_size + meshlets_size;
+			staging.mapped_vertices = vertex_buffer_view::interleaved(
+				format, staging.position_scale, staging.position_offset, { data + submeshes_size, vertices_size });
+			staging.mapped_indices = { data + submeshes_size + vertices_size, indices_size };
+			return staging;
+		}
+
+		/* write the cooked version of a source mesh: its deduplicated vertex and index buffers. */
+		static void cook(const stdfs::path &source, const stdfs::path &output) {
+			auto staging = stage_from_source(source, false);
+			if(staging.cache_after.triangles > 0) {
+				fmt::print("{}: acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}\n", source,
+					staging.cache_before.acmr(), staging.cache_after.acmr(),
+					staging.cache_before.atvr(), staging.cache_after.atvr());
+			}
+			for(size_t i = 1; i < staging.lods.size(); ++i) {
+				const auto &level = staging.lods[i];
+				size_t index_count = 0;
+				for(uint32_t s = 0; s < level.submesh_count; ++s) index_count += staging.submeshes[level.first_submesh + s].index_count;
+				fmt::print("{}: lod {}: {} triangles, error {:.4f}\n", source, i, index_count / 3, level.error);
+			}
+			if(!staging.meshlets.empty()) fmt::print("{}: {} meshlets\n", source, staging.meshlets.size());
+			::gfx::cooked::mesh_header header {
+				.version = ::gfx::cooked::version,
+				.mode = uint32_t(staging.mode),
+				.indexed = staging.indexed,
+				.vertex_count = uint32_t(staging.vertices.size()), .vertex_size = staging.format.stride(),
+				.index_count = uint32_t(staging.indices.size()), .index_size = staging.index_size,
+				.submesh_count = uint32_t(staging.submeshes.size()),
+				.lod_count = uint32_t(staging.lods.size()),
+				.meshlet_count = uint32_t(staging.meshlets.size()),
+				.vertex_format = staging.format.to_bits(),
+			};
+			std::memcpy(header.magic, ::gfx::cooked::mesh_magic, sizeof(header.magic));
+			std::memcpy(header.position_scale, &staging.position_scale, sizeof(header.position_scale));
+			std::memcpy(header.position_offset, &staging.position_offset, sizeof(header.position_offset));
+			std::memcpy(header.bounding_sphere, &staging.bounding_sphere, sizeof(header.bounding_sphere));
+			std::memcpy(header.bounding_box, &staging.bounding_box, sizeof(header.bounding_box));
+			::gfx::cooked::write(output, {
+				std::as_bytes(std::span(&header, 1)),
+				std::as_bytes(std::span(staging.submeshes)),
+				std::as_bytes(std::span(staging.lods)),
+				std::as_bytes(std::span(staging.meshlets)),
+				std::as_bytes(std::span(staging.packed_vertices)),
+				std::as_bytes(std::span(staging.packed_indices)),
+			});
+		}
+
+		/* maps the files cgltf reads instead of copying them, so a .glb binary
+		 * chunk or an external .bin file can be uploaded straight from the map. */
+		struct gltf_files_ {
+			std::vector<std::shared_ptr<const ::util::mapped_file>> mappings;
+
+			static cgltf_result read(
+				const cgltf_memory_options *memory, const cgltf_file_options *file,
+				const char *path, cgltf_size *size, void **data
+			) {
+				auto &mappings = ((gltf_files_*)file->user_data)->mappings;
+				mappings.push_back(std::make_shared<const ::util::mapped_file>(path, true));
+				*size = mappings.back()->size();
+				*data = (void*)mappings.back()->data();
+				return cgltf_result_success;
+			}
+
+			/* the maps are owned by `mappings`, which outlives the cgltf data. */
+			static void release(const cgltf_memory_options *memory, const cgltf_file_options *file, void *data) {}
+
+			/* the map `bytes` points into, if any. */
+			std::shared_ptr<const ::util::mapped_file> find(const void *bytes) const {
+				for(const auto &mapping : mappings) {
+					const std::byte *p = (const std::byte*)bytes;
+					if(p >= mapping->data() && p < mapping->data() + mapping->size()) return mapping;
+				}
+				return nullptr;
+			}
+		};
+
+		/* load every triangle primitive of every mesh in a .gltf or .glb file
+		 * into one mesh, with the transforms of the nodes they're used by.
+		 *
+		 * if `zero_copy` is set and the file holds a single untransformed
+		 * primitive with float positions, normals and texcoords and 16 or 32-bit
+		 * indices, the buffer views are uploaded straight from the mapped file
+		 * in the `vertex_format::full` format, without the vertex cache
+		 * optimization. */
+		static staging_type stage_from_gltf(const char *path, bool zero_copy = true) {
+			gltf_files_ files;
+			cgltf_options options {};
+			options.file = { &gltf_files_::read, &gltf_files_::release, &files };
+			cgltf_data *data = NULL;
+			cgltf_result result = cgltf_parse_file(&options, path, &data);
+			// freed on every return, and when a reload recovers from a failure below.
+			std::unique_ptr<cgltf_data, decltype(&cgltf_free)> owner(data, cgltf_free);
+			if(result == cgltf_result_success) result = cgltf_load_buffers(&options, data, path);
+			if(result == cgltf_result_success) result = cgltf_validate(data);
+			if(result != cgltf_result_success) {
+				::util::fail_error("Failed to load gltf mesh: {}", ::util::cgltf_result_string(result));
+			}
+
+			/* meshes no node uses are loaded as they are. */
+			std::vector<std::pair<const cgltf_mesh*, glm::mat4>> instances;
+			std::vector<bool> used(data->meshes_count);
+			for(size_t i = 0; i < data->nodes_count; ++i) {
+				const cgltf_node &node = data->nodes[i];
+				if(node.mesh == NULL) continue;
+				glm::mat4 transform;
+				cgltf_node_transform_world(&node, &transform[0][0]);
+				instances.push_back({ node.mesh, transform });
+				used[node.mesh - data->meshes] = true;
+			}
+			for(size_t i = 0; i < data->meshes_count; ++i)
+				if(!used[i]) instances.push_back({ &data->meshes[i], glm::mat4(1.0f) });
+
+			if(zero_copy && instances.size() == 1 && instances[0].first->primitives_count == 1
+			&& instances[0].second == glm::mat4(1.0f)) {
+				if(auto staging = stage_gltf_mapped_(instances[0].first->primitives[0], files))
+					return std::move(*staging);
+			}
+
+			std::vector<vertex_type> corners; /* of the triangles. */
+			for(const auto &[mesh, transform] : instances) {
+				glm::mat4 normal_transform = glm::transpose(glm::inverse(transform));
+				bool flip = glm::determinant(transform) < 0.0f; /* mirrored, keep the winding. */
+				for(size_t p = 0; p < mesh->primitives_count; ++p) {
+					const cgltf_primitive &primitive = mesh->primitives[p];
+					if(primitive.type != cgltf_primitive_type_triangles
+					&& primitive.type != cgltf_primitive_type_triangle_strip
+					&& primitive.type != cgltf_primitive_type_triangle_fan) continue;
+					if(primitive.has_draco_mesh_compression)
+						::util::fail_error("Unsupported draco compressed gltf mesh: {}", path);
+
+					auto attributes = gltf_attributes_(primitive);
+					if(attributes[0] == NULL) continue;
+					size_t count = attributes[0]->count;
+					std::vector<float> positions = gltf_unpack_(attributes[0], count, cgltf_type_vec3);
+					std::vector<float> normals = gltf_unpack_(attributes[1], count, cgltf_type_vec3);
+					std::vector<float> texcoords = gltf_unpack_(attributes[2], count, cgltf_type_vec2);
+					auto vertex_at = [&](uint32_t i) {
+						if(i >= count) ::util::fail_error("Out of range gltf index: {} in {}", i, path);
+						vertex_type vertex {};
+						glm::vec4 pos = transform * glm::vec4(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2], 1.0f);
+						vertex.pos = { pos.x, pos.y, pos.z };
+						glm::vec4 norm = normal_transform * glm::vec4(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2], 0.0f);
+						vertex.norm = { norm.x, norm.y, norm.z };
+						if(vertex.norm != glm::vec3(0.0f)) vertex.norm = glm::normalize(vertex.norm);
+						vertex.texcoord = { texcoords[2 * i], texcoords[2 * i + 1] };
+						return vertex;
+					};
+					auto add_triangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+						if(flip) std::swap(b, c);
+						for(uint32_t i : { a, b, c }) corners.push_back(vertex_at(i));
+					};
+
+					auto indices = gltf_indices_(primitive, count);
+					if(primitive.type == cgltf_primitive_type_triangles) {
+						for(size_t i = 0; i + 2 < indices.size(); i += 3)
+							add_triangle(indices[i], indices[i + 1], indices[i + 2]);
+					} else if(primitive.type == cgltf_primitive_type_triangle_strip) {
+						for(size_t i = 0; i + 2 < indices.size(); ++i) {
+							uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+							if(a == b || b == c || a == c) continue; /* joins strips. */
+							if(i % 2 == 0) add_triangle(a, b, c);
+							else add_triangle(b, a, c);
+						}
+					} else {
+						for(size_t i = 1; i + 1 < indices.size(); ++i)
+							add_triangle(indices[0], indices[i], indices[i + 1]);
+					}
+				}
+			}
+			owner.reset();
+
+			staging_type staging;
+			staging.indexed = true;
+			staging.indices.resize(corners.size());
+			::gfx::weld::apply<vertex_type>(corners, staging.vertices, staging.indices);
+			finish_indices(staging);
+			pack_vertices(staging);
+			return staging;
+		}
+
+		/* the POSITION, NORMAL and TEXCOORD_0 accessors of `primitive`, or NULL. */
+		static std::array<const cgltf_accessor*, 3> gltf_attributes_(const cgltf_primitive &primitive) {
+			std::array<const cgltf_accessor*, 3> accessors {};
+			for(size_t i = 0; i < primitive.attributes_count; ++i) {
+				const cgltf_attribute &attribute = primitive.attributes[i];
+				if(attribute.index != 0) continue;
+				switch(attribute.type) {
+				case cgltf_attribute_type_position: accessors[0] = attribute.data; break;
+				case cgltf_attribute_type_normal: accessors[1] = attribute.data; break;
+				case cgltf_attribute_type_texcoord: accessors[2] = attribute.data; break;
+				default: break;
+				}
+			}
+			return accessors;
 		}
 
-		void load_from_gltf(::res::res_manager &m, const ::res::res_id_type &id, const char *path) {
-			cgltf_options options {};
-			cgltf_data *data = NULL;
-			cgltf_result result = cgltf_parse_file(&options, path, &data);
-			if(result != cgltf_result_success) {
-				::util::fail_error("Failed to load gltf mesh: {}", ::util::cgltf_result_string(result));
+		/* `count` elements of `accessor` as floats, with sparse values applied.
+		 * missing accessors and elements are zero. */
+		static std::vector<float> gltf_unpack_(const cgltf_accessor *accessor, size_t count, cgltf_type type) {
+			std::vector<float> out(count * cgltf_num_components(type));
+			if(accessor != NULL && accessor->type == type)
+				cgltf_accessor_unpack_floats(accessor, out.data(), out.size());
+			return out;
+		}
+
+		/* the indices of `primitive` with sparse values applied, or 0..`vertex_count` if it has none. */
+		static std::vector<uint32_t> gltf_indices_(const cgltf_primitive &primitive, size_t vertex_count) {
+			std::vector<uint32_t> indices;
+			const cgltf_accessor *accessor = primitive.indices;
+			if(accessor == NULL) {
+				indices.resize(vertex_count);
+				std::iota(indices.begin(), indices.end(), 0);
+				return indices;
+			}
+
+			cgltf_accessor dense = *accessor;
+			dense.is_sparse = false;
+			indices.resize(accessor->count);
+			for(size_t i = 0; i < indices.size(); ++i)
+				indices[i] = cgltf_accessor_read_index(&dense, i);
+
+			if(accessor->is_sparse) {
+				auto read = [](const uint8_t *p, cgltf_component_type type) -> uint32_t {
+					switch(type) {
+					case cgltf_component_type_r_8u: return *p;
+					case cgltf_component_type_r_16u: { uint16_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+					case cgltf_component_type_r_32u: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+					default: return 0;
+					}
+				};
+				const cgltf_accessor_sparse &sparse = accessor->sparse;
+				const uint8_t *targets = cgltf_buffer_view_data(sparse.indices_buffer_view) + sparse.indices_byte_offset;
+				const uint8_t *values = cgltf_buffer_view_data(sparse.values_buffer_view) + sparse.values_byte_offset;
+				size_t target_size = cgltf_component_size(sparse.indices_component_type);
+				size_t value_size = cgltf_component_size(accessor->component_type);
+				for(size_t i = 0; i < sparse.count; ++i) {
+					uint32_t target = read(targets + i * target_size, sparse.indices_component_type);
+					if(target < indices.size()) indices[target] = read(values + i * value_size, accessor->component_type);
+				}
 			}
-			// for(size_t i = 0; i < data->meshes_count; ++i) {
-			// 	data->meshes[i].primitives[0].material;
-			// }
-			cgltf_free(data);
+			return indices;
 		}
 
-		void load_from_obj(::res::res_manager &m, const ::res::res_id_type &id, const char *path) {
-			tinyobj::attrib_t attrib;
-			std::vector<tinyobj::shape_t> shapes;
-			std::vector<tinyobj::material_t> materials;
-			std::string warn, err;
+		/* stage `primitive` for uploading its buffer views as they are, if their layout allows it. */
+		static std::optional<staging_type> stage_gltf_mapped_(const cgltf_primitive &primitive, const gltf_files_ &files) {
+			staging_type staging;
+			switch(primitive.type) {
+			case cgltf_primitive_type_triangles: staging.mode = mesh_mode::triangles; break;
+			case cgltf_primitive_type_triangle_strip: staging.mode = mesh_mode::triangle_strip; break;
+			case cgltf_primitive_type_triangle_fan: staging.mode = mesh_mode::triangle_fan; break;
+			default: return std::nullopt;
+			}
+			if(primitive.has_draco_mesh_compression) return std::nullopt;
+
+			auto usable = [&](const cgltf_accessor *accessor) {
+				return !accessor->is_sparse && accessor->buffer_view != NULL
+					&& accessor->buffer_view->data == NULL && accessor->count > 0
+					&& files.find(accessor->buffer_view->buffer->data) != nullptr;
+			};
+			auto add_mapping = [&](const cgltf_accessor *accessor) {
+				auto mapping = files.find(accessor->buffer_view->buffer->data);
+				if(std::ranges::find(staging.mappings, mapping) == staging.mappings.end())
+					staging.mappings.push_back(mapping);
+			};
+			auto bytes_of = [](const cgltf_accessor *accessor) {
+				return (const std::byte*)accessor->buffer_view->buffer->data + accessor->buffer_view->offset + accessor->offset;
+			};
+
+			auto attributes = gltf_attributes_(primitive);
+			constexpr cgltf_type types[3] { cgltf_type_vec3, cgltf_type_vec3, cgltf_type_vec2 };
+			if(attributes[0] == NULL) return std::nullopt;
+			const cgltf_buffer *buffer = attributes[0]->buffer_view ? attributes[0]->buffer_view->buffer : NULL;
+			const std::byte *begin = nullptr, *end = nullptr;
+			for(size_t i = 0; i < 3; ++i) {
+				const cgltf_accessor *accessor = attributes[i];
+				if(accessor == NULL) continue;
+				if(!usable(accessor) || accessor->buffer_view->buffer != buffer || accessor->count != attributes[0]->count
+				|| accessor->type != types[i] || accessor->component_type != cgltf_component_type_r_32f || accessor->normalized)
+					return std::nullopt;
+				const std::byte *first = bytes_of(accessor);
+				const std::byte *last = first + accessor->stride * (accessor->count - 1) + cgltf_calc_size(accessor->type, accessor->component_type);
+				begin = begin ? std::min(begin, first) : first;
+				end = end ? std::max(end, last) : last;
+			}
 
-			if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path)) {
-				::util::fail_error("Failed to load .obj file:\n{}", warn + err);
+			if(const cgltf_accessor *accessor = primitive.indices) {
+				if(!usable(accessor) || accessor->stride != cgltf_component_size(accessor->component_type)
+				|| (accessor->component_type != cgltf_component_type_r_16u && accessor->component_type != cgltf_component_type_r_32u))
+					return std::nullopt;
+				staging.indexed = true;
+				staging.index_size = accessor->stride;
+				staging.mapped_indices = { bytes_of(accessor), accessor->count * accessor->stride };
+				staging.submeshes.push_back({ 0, uint32_t(accessor->count), 0 });
+				add_mapping(accessor);
 			}
 
-			std::unordered_map<vertex_type, index_type, decltype([](const vertex_type &v) {
-				return (
-					(std::hash<glm::vec3>()(v.pos) ^
-					(std::hash<glm::vec3>()(v.norm) << 1)) >> 1
-				) ^ (std::hash<glm::vec2>()(v.texcoord) << 1);
-			})> unique_vertices{};
+			const cgltf_accessor *position = attributes[0];
+			if(position->has_min && position->has_max) {
+				glm::vec3 lo { position->min[0], position->min[1], position->min[2] };
+				glm::vec3 hi { position->max[0], position->max[1], position->max[2] };
+				staging.bounding_box = { lo, hi };
+				staging.bounding_sphere = { (lo + hi) * 0.5f, glm::length(hi - lo) * 0.5f };
+			} else {
+				std::vector<vertex_type> points(position->count);
+				for(size_t i = 0; i < points.size(); ++i) cgltf_accessor_read_float(position, i, &points[i].pos.x, 3);
+				std::tie(staging.bounding_box, staging.bounding_sphere) = bounds_of_(points);
+			}
 
-			std::vector<vertex_type> vertices;
-			std::vector<index_type> indices;
-
-			for (const auto &shape : shapes) {
-				for (const auto &index : shape.mesh.indices) {
-					vertex_type vertex {};
-					vertex.pos = {
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2]
-					};
+			auto &vertices = staging.mapped_vertices;
+			vertices.format = ::gfx::vertex_format::full();
+			vertices.bytes = { begin, size_t(end - begin) };
+			vertices.count = attributes[0]->count;
+			for(size_t i = 0; i < 3; ++i) {
+				if(attributes[i] == NULL) continue;
+				vertices.offsets[i] = bytes_of(attributes[i]) - begin;
+				vertices.strides[i] = attributes[i]->stride;
+			}
+			staging.format = vertices.format;
+			add_mapping(attributes[0]);
+			return staging;
+		}
 
+		static staging_type stage_from_obj(const char *path) {
+			auto obj = ::gfx::obj::parse_file(path);
+
+			std::vector<vertex_type> corners(obj.indices.size());
+			for(size_t i = 0; i < corners.size(); ++i) {
+				const auto &index = obj.indices[i];
+				auto &vertex = corners[i];
+				vertex = {};
+				vertex.pos = {
+					obj.positions[3 * index.pos + 0],
+					obj.positions[3 * index.pos + 1],
+					obj.positions[3 * index.pos + 2]
+				};
+
+				if(index.norm >= 0) {
 					vertex.norm = {
-						attrib.normals[3 * index.normal_index + 0],
-						attrib.normals[3 * index.normal_index + 1],
-						attrib.normals[3 * index.normal_index + 2]
+						obj.normals[3 * index.norm + 0],
+						obj.normals[3 * index.norm + 1],
+						obj.normals[3 * index.norm + 2]
 					};
+				}
 
+				if(index.texcoord >= 0) {
 					vertex.texcoord = {
-						attrib.texcoords[2 * index.texcoord_index + 0],
-						attrib.texcoords[2 * index.texcoord_index + 1]
+						obj.texcoords[2 * index.texcoord + 0],
+						obj.texcoords[2 * index.texcoord + 1]
 					};
+				}
+			}
 
-					if(unique_vertices.count(vertex) == 0) {
-						unique_vertices[vertex] = vertices.size();
-						vertices.push_back(vertex);
-					}
+			staging_type staging;
+			staging.indexed = true;
+			staging.indices.resize(corners.size());
+			::gfx::weld::apply<vertex_type>(corners, staging.vertices, staging.indices);
+			finish_indices(staging);
+			pack_vertices(staging);
+			return staging;
+		}
+
+		/* bounding box of `vertices`, and the smallest sphere around them centered on it. */
+		static std::pair<::gfx::aabb, ::gfx::sphere> bounds_of_(std::span<const vertex_type> vertices) {
+			if(vertices.empty()) return {};
+			::gfx::aabb box { vertices[0].pos, vertices[0].pos };
+			for(const auto &v : vertices) {
+				box.lo = glm::min(box.lo, v.pos);
+				box.hi = glm::max(box.hi, v.pos);
+			}
+			::gfx::sphere sphere { (box.lo + box.hi) * 0.5f, 0.0f };
+			for(const auto &v : vertices)
+				sphere.radius = std::max(sphere.radius, glm::distance(v.pos, sphere.center));
+			return { box, sphere };
+		}
 
-					indices.push_back(unique_vertices[vertex]);
+		/* append up to `max_lods` - 1 simplified levels of the submeshes to
+		 * `staging.indices`, each simplified from the previous one. */
+		static void add_lods_(staging_type &staging) {
+			size_t base_count = staging.submeshes.size();
+			staging.lods = { { 0, uint32_t(base_count), 0.0f } };
+			float max_error = lod_max_error * bounds_of_(staging.vertices).second.radius;
+			std::vector<std::vector<uint32_t>> levels(base_count);
+			for(size_t i = 0; i < base_count; ++i) {
+				const auto &sub = staging.submeshes[i];
+				levels[i].assign(staging.indices.begin() + sub.first_index, staging.indices.begin() + sub.first_index + sub.index_count);
+			}
+
+			float error = 0.0f;
+			for(size_t level = 1; level < max_lods && error < max_error; ++level) {
+				size_t before = 0, after = 0;
+				float level_error = 0.0f;
+				for(size_t i = 0; i < base_count; ++i) {
+					const auto &sub = staging.submeshes[i];
+					size_t vertex_end = i + 1 < base_count ? staging.submeshes[i + 1].base_vertex : staging.vertices.size();
+					auto vertices = std::span<const vertex_type>(staging.vertices).subspan(sub.base_vertex, vertex_end - sub.base_vertex);
+					float submesh_error = 0.0f;
+					size_t target = size_t(levels[i].size() / 3 * lod_ratio) * 3;
+					auto simplified = ::gfx::lod::simplify<vertex_type>(vertices, levels[i], target, max_error - error, &submesh_error);
+					std::vector<uint32_t> clusters;
+					before += levels[i].size();
+					levels[i] = ::gfx::vcache::tipsify(simplified, vertices.size(), clusters);
+					after += levels[i].size();
+					level_error = std::max(level_error, submesh_error);
+				}
+				// stop once simplification stalls, the level would barely be cheaper.
+				if(after == 0 || after * 10 > before * 9) break;
+				error += level_error;
+
+				staging.lods.push_back({ uint32_t(staging.submeshes.size()), uint32_t(base_count), error });
+				for(size_t i = 0; i < base_count; ++i) {
+					staging.submeshes.push_back({ uint32_t(staging.indices.size()), uint32_t(levels[i].size()), staging.submeshes[i].base_vertex });
+					staging.indices.insert(staging.indices.end(), levels[i].begin(), levels[i].end());
 				}
 			}
+		}
 
-			load_from_data(mesh_mode::triangles, vertices, indices);
+		/* vertices from the base vertex of `sub` to the next base vertex. */
+		static size_t vertex_count_of_(const staging_type &staging, const submesh &sub) {
+			size_t end = staging.vertices.size();
+			for(const auto &other : staging.submeshes)
+				if(other.base_vertex > sub.base_vertex) end = std::min<size_t>(end, other.base_vertex);
+			return end - sub.base_vertex;
+		}
+
+		/* reorder the triangles of every submesh, lods included, into meshlets. */
+		static void add_meshlets_(staging_type &staging) {
+			staging.meshlets.clear();
+			for(auto &sub : staging.submeshes) {
+				auto meshlets = ::gfx::cluster::build<vertex_type>(
+					std::span<const vertex_type>(staging.vertices).subspan(sub.base_vertex, vertex_count_of_(staging, sub)),
+					std::span(staging.indices).subspan(sub.first_index, sub.index_count));
+				sub.first_meshlet = staging.meshlets.size();
+				sub.meshlet_count = meshlets.size();
+				for(auto &m : meshlets) {
+					m.first_index += sub.first_index;
+					staging.meshlets.push_back(m);
+				}
+			}
 		}
 
-		void set_vertex_attributes() {			
-			glVertexArrayAttribFormat(vao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(vertex_type, pos));
-			glVertexArrayAttribBinding(vao, 0, 0);
-			glEnableVertexArrayAttrib(vao, 0);
+		/* split a triangle list into submeshes of at most `max_u16_vertices`
+		 * vertices each, every submesh gets its own copy of the vertices it uses. */
+		static void split_u16_(staging_type &staging) {
+			constexpr uint32_t unused = UINT32_MAX;
+			std::vector<vertex_type> vertices;
+			std::vector<uint32_t> indices;
+			std::vector<submesh> submeshes;
+			std::vector<uint32_t> local(staging.vertices.size(), unused); /* in the current submesh. */
+			std::vector<uint32_t> used; /* vertices of the current submesh. */
+
+			auto close = [&] {
+				submesh sub { submeshes.empty() ? 0 : submeshes.back().first_index + submeshes.back().index_count, 0, 0 };
+				sub.index_count = indices.size() - sub.first_index;
+				sub.base_vertex = vertices.size() - used.size();
+				submeshes.push_back(sub);
+				for(uint32_t v : used) local[v] = unused;
+				used.clear();
+			};
+
+			const auto &in = staging.indices;
+			for(size_t i = 0; i + 2 < in.size(); i += 3) {
+				uint32_t a = in[i], b = in[i + 1], c = in[i + 2];
+				size_t added = (local[a] == unused)
+					+ (local[b] == unused && b != a)
+					+ (local[c] == unused && c != a && c != b);
+				if(used.size() + added > max_u16_vertices) close();
+				for(uint32_t v : { a, b, c }) {
+					if(local[v] == unused) {
+						local[v] = used.size();
+						used.push_back(v);
+						vertices.push_back(staging.vertices[v]);
+					}
+					indices.push_back(local[v]);
+				}
+			}
+			if(!used.empty()) close();
 
-			glVertexArrayAttribFormat(vao, 1, 3, GL_FLOAT, GL_FALSE, offsetof(vertex_type, norm));
-			glVertexArrayAttribBinding(vao, 1, 0);
-			glEnableVertexArrayAttrib(vao, 1);
-			
-			glVertexArrayAttribFormat(vao, 2, 2, GL_FLOAT, GL_FALSE, offsetof(vertex_type, texcoord));
-			glVertexArrayAttribBinding(vao, 2, 0);
-			glEnableVertexArrayAttrib(vao, 2);
+			staging.vertices = std::move(vertices);
+			staging.indices = std::move(indices);
+			staging.submeshes = std::move(submeshes);
+		}
+
+		/* interleaved vertices go into the pool of their format. the rest (e.g.
+		 * glTF buffers used as-is) get a vertex array and buffer of their own. */
+		void set_vertex_buffer_(const vertex_buffer_view &vertices) {
+			sort_id = next_sort_id_++;
+			format = vertices.format;
+			position_scale = vertices.position_scale;
+			position_offset = vertices.position_offset;
+			vertex_count = vertices.count;
+			vertex_bytes = vertices.bytes.size();
+			if(use_geometry_pool && vertices.is_interleaved()) {
+				pool = &::gfx::geometry_pool::of(format);
+				pool_vertices = pool->add_vertices(vertices.bytes);
+				first_vertex = pool_vertices.offset;
+				vao = pool->vao();
+				return;
+			}
+			pool = nullptr;
+			first_vertex = 0;
+			glCreateVertexArrays(1, &vao);
+			glCreateBuffers(1, &vbo);
+			glNamedBufferData(vbo, vertices.bytes.size(), vertices.bytes.data(), GL_STATIC_DRAW);
+			format.set_attributes(vao, vbo, vertices.offsets, vertices.strides);
 		}
 
+		/* `indices` holds `index_size` byte indices, drawn in `submeshes`. */
 		void load_from_data(
 			mesh_mode mode,
-			const std::span<vertex_type> &vertices,
-			const std::span<index_type> &indices
+			const vertex_buffer_view &vertices,
+			const std::span<const std::byte> &indices,
+			uint32_t index_size,
+			const std::span<const submesh> &submeshes,
+			const std::span<const lod_level> &lods = {},
+			const std::span<const ::gfx::cluster::meshlet> &meshlets = {}
 		) {
-			clog.println("vertices: {}", vertices.size());
-			clog.println("indices: {}", indices.size());
+			clog.println("vertices: {} ({} bytes)", vertices.count, vertices.bytes.size());
+			clog.println("indices: {} ({} bytes each, {} submeshes)", indices.size() / index_size, index_size, submeshes.size());
 			indexed = true;
 			this->mode = mode;
-			vertex_count = vertices.size();
-			index_count = indices.size();
-
-			glCreateVertexArrays(1, &vao);
-			glCreateBuffers(1, &vbo);
+			index_count = indices.size() / index_size;
+			this->index_size = index_size;
+			this->submeshes.assign(submeshes.begin(), submeshes.end());
+			if(lods.empty()) {
+				this->lods = { { 0, uint32_t(submeshes.size()), 0.0f } };
+			} else {
+				this->lods.assign(lods.begin(), lods.end());
+				clog.println("lods: {}", lods.size());
+			}
+			this->meshlets.assign(meshlets.begin(), meshlets.end());
+			if(!meshlets.empty()) clog.println("meshlets: {}", meshlets.size());
+			set_vertex_buffer_(vertices);
+
+			if(pool != nullptr) {
+				pool_indices = pool->add_indices(indices);
+				index_offset = pool_indices.offset;
+				return;
+			}
+			index_offset = 0;
 			glCreateBuffers(1, &ebo);
 			glVertexArrayElementBuffer(vao, ebo);
-			glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(vertex_type));
-			glNamedBufferData(vbo, vertices.size_bytes(), vertices.data(), GL_STATIC_DRAW);
 			glNamedBufferData(ebo, indices.size_bytes(), indices.data(), GL_STATIC_DRAW);
-			set_vertex_attributes();
 		}
 
 		void load_from_data(
 			mesh_mode mode,
-			const std::span<vertex_type> &vertices
+			const vertex_buffer_view &vertices
 		) {
-			clog.println("vertices: {}", vertices.size());
+			clog.println("vertices: {} ({} bytes)", vertices.count, vertices.bytes.size());
 			clog.println("indices: none");
 			indexed = false;
 			this->mode = mode;
-			vertex_count = vertices.size();
 			index_count = 0;
-			glCreateVertexArrays(1, &vao);
-			glCreateBuffers(1, &vbo);
-			glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(vertex_type));
-			glNamedBufferData(vbo, vertices.size_bytes(), vertices.data(), GL_STATIC_DRAW);
-			set_vertex_attributes();
+			index_size = 0;
+			index_offset = 0;
+			pool_indices = {};
+			submeshes.clear();
+			lods.clear();
+			meshlets.clear();
+			set_vertex_buffer_(vertices);
 		}
 	};
 
@@ -986,8 +4825,12 @@ namespace gfx {
 
 		using value_type = std::variant<int, float, glm::vec2, glm::vec3, glm::vec4, glm::mat4>;
 
+		static constexpr ::gfx::shader::slot_type unresolved_slot = -2;
+
 		struct param_type {
+			::util::string_id name;
 			value_type value;
+			::gfx::shader::slot_type slot = unresolved_slot; /* in the shader, see `gfx::renderer::bind_material`. */
 			bool dirty = true;
 
 			template<typename T>
@@ -997,61 +4840,119 @@ namespace gfx {
 			}
 		};
 
-		std::unordered_map<std::string, param_type> params;
+		std::vector<param_type> params; /* few, so searched by name only when set. */
+		GLuint slots_program = 0; /* the program the param slots were resolved in. */
 		std::vector<texture_binding> textures;
 		// note: sizeof(value_type) is large
 		::res_ref<shader> shader;
+		uint32_t sort_id = 0; /* see `gfx::render_queue`. */
+		static inline uint32_t next_sort_id_ = 0;
+
+		param_type &param_(::util::string_id name) {
+			for(auto &param : params)
+				if(param.name == name) return param;
+			return params.emplace_back(param_type { .name = name });
+		}
 	public:
-		void set(strv name, float v) { params[name.data()].set(v); }
-		void set(strv name, const glm::vec2 &v) { params[name.data()].set(v); }
-		void set(strv name, const glm::vec3 &v) { params[name.data()].set(v); }
-		void set(strv name, const glm::vec4 &v) { params[name.data()].set(v); }
-		void set(strv name, const glm::mat4 &v) { params[name.data()].set(v); }
+		void set(::util::string_id name, float v) { param_(name).set(v); }
+		void set(::util::string_id name, const glm::vec2 &v) { param_(name).set(v); }
+		void set(::util::string_id name, const glm::vec3 &v) { param_(name).set(v); }
+		void set(::util::string_id name, const glm::vec4 &v) { param_(name).set(v); }
+		void set(::util::string_id name, const glm::mat4 &v) { param_(name).set(v); }
+
+		template<typename T>
+		void set(strv name, const T &v) { set(::util::string_id::of(name), v); }
+
+		struct staging_type {
+			nmann::json json;
+		};
+
+		static staging_type stage_from_file(const stdfs::path &path) {
+			return { ::util::json::read_file(path) };
+		}
 
 		void unload(::res::res_manager &m, const ::res::res_id_type &id) {}
 		void load_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
+			load_from_staging(m, id, path, stage_from_file(path));
+		}
+
+		/* load into a new material and only replace this one if that worked,
+		 * so that saving broken json keeps the old version. */
+		bool reload_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
+			material fresh;
+			try {
+				::util::recoverable_failures recoverable;
+				fresh.load_from_staging(m, id, path, stage_from_file(path));
+			} catch(const ::util::failure &) {
+				return false;
+			} catch(const std::exception &e) {
+				::util::print_error("Failed to reload material {}: {}", path, e.what());
+				return false;
+			}
+			*this = std::move(fresh);
+			return true;
+		}
+
+		::res::res_usage get_usage() const {
+			return { sizeof(material) + params.size() * sizeof(param_type) + textures.size() * sizeof(texture_binding), 0 };
+		}
+
+		/* a relinked shader forgets all uniform values and may move them, so the
+		 * next bind resolves the slots and uploads every param again. */
+		void refresh_dependency(::res::res_manager &m, const ::res::res_id_type &id, const ::res::res_id_type &dep) {
+			slots_program = 0;
+		}
+
+		void load_from_staging(
+			::res::res_manager &m,
+			const ::res::res_id_type &id,
+			const stdfs::path &path,
+			staging_type &&staging
+		) {
 			clog.println("path: {}", path);
-			auto res = ::util::json::read_file(path);
+			sort_id = next_sort_id_++;
+			auto &res = staging.json;
 			::util::json::assert_type(res, ::util::json::value_kind::object);
 			::util::json::read_res_name_or_uuid(res, "shader", "shader-uuid", m, shader.id);
 			m.add_dependency(id, shader.id);
 			if(res.contains("params")) {
 				::util::json::assert_type(res["params"], ::util::json::value_kind::object);
-				for(auto &[key, value] : res["params"].items()) {
+				for(auto &[name, value] : res["params"].items()) {
+					auto key = ::util::string_id::intern(name);
 					::util::json::assert_type(value,
 						::util::json::value_kind::number,
 						::util::json::value_kind::array,
 						::util::json::value_kind::string);
 					if(value.is_number()) {
-						params[key].value = value.get<int>();
+						param_(key).value = value.get<int>();
 					} else if(value.is_string()) {
 						const auto &type = value.get_ref<const std::string&>();
-						if(type == "") params[key].value = 0;
-						else if(type == "int") params[key].value = 0;
-						else if(type == "float") params[key].value = 0.0f;
-						else if(type == "vec2") params[key].value = glm::vec2{};
-						else if(type == "vec3") params[key].value = glm::vec2{};
-						else if(type == "vec4") params[key].value = glm::vec2{};
-						else if(type == "mat4") params[key].value = glm::vec2{};
+						if(type == "") param_(key).value = 0;
+						else if(type == "int") param_(key).value = 0;
+						else if(type == "float") param_(key).value = 0.0f;
+						else if(type == "vec2") param_(key).value = glm::vec2{};
+						else if(type == "vec3") param_(key).value = glm::vec2{};
+						else if(type == "vec4") param_(key).value = glm::vec2{};
+						else if(type == "mat4") param_(key).value = glm::vec2{};
 						else {
 							::util::fail_error("Invalid material parameter type: '{}', "
 								"must be one of [int, float, vec2, vec3, vec4, mat4]", type);
 						}
 					} else {
-						if(value.size() == 1) params[key].value = value[0].get<float>();
+						if(value.size() == 1) param_(key).value = value[0].get<float>();
 						else if(value.size() == 2) {
-							params[key].value = glm::vec2(
+							param_(key).value = glm::vec2(
 								value[0].get<float>(),
 								value[1].get<float>()
 							);
 						} else if(value.size() == 3) {
-							params[key].value = glm::vec3(
+							param_(key).value = glm::vec3(
 								value[0].get<float>(),
 								value[1].get<float>(),
 								value[2].get<float>()
 							);
 						} else if(value.size() == 4) {
-							params[key].value = glm::vec4(
+							param_(key).value = glm::vec4(
 								value[0].get<float>(),
 								value[1].get<float>(),
 								value[2].get<float>(),
@@ -1083,10 +4984,27 @@ namespace gfx {
 		friend ::gfx::renderer;
 		std::vector<std::pair<::res_ref<::gfx::mesh>, ::res_ref<::gfx::material>>> parts;
 	public:
+		struct staging_type {
+			nmann::json json;
+		};
+
+		static staging_type stage_from_file(const stdfs::path &path) {
+			return { ::util::json::read_file(path) };
+		}
+
 		void unload(::res::res_manager &m, const ::res::res_id_type &id) {}
 		void load_from_file(::res::res_manager &m, const ::res::res_id_type &id, const stdfs::path &path) {
+			load_from_staging(m, id, path, stage_from_file(path));
+		}
+
+		void load_from_staging(
+			::res::res_manager &m,
+			const ::res::res_id_type &id,
+			const stdfs::path &path,
+			staging_type &&staging
+		) {
 			clog.println("path: {}", path);
-			auto res = ::util::json::read_file(path);
+			auto &res = staging.json;
 			::util::json::assert_type(res, ::util::json::value_kind::object);
 			::util::json::assert_contains(res, "parts");
 			::util::json::assert_type(res["parts"], ::util::json::value_kind::array);
@@ -1208,12 +5126,245 @@ namespace gfx {
 		}
 	};
 
+	/* a buffer the cpu writes every frame and the gpu reads, mapped once and
+	 * kept mapped. it is split into a region per frame in flight, used in
+	 * turn, and a region is only written again once the fence placed at the
+	 * end of its frame has passed. */
+	class stream_buffer {
+	public:
+		static constexpr size_t frames = 3;
+
+		/* `offset` is from the start of the buffer. */
+		struct range {
+			std::byte *data = nullptr;
+			GLintptr offset = 0;
+		};
+	private:
+		GLuint id_ = 0;
+		std::byte *data_ = nullptr;
+		size_t region_size_ = 0, frame_ = 0, cursor_ = 0;
+		std::array<GLsync, frames> fences_ {};
+
+		void wait_(GLsync &fence) {
+			if(fence == nullptr) return;
+			while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {}
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		void create_(size_t region_size) {
+			constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			region_size_ = region_size;
+			glCreateBuffers(1, &id_);
+			glNamedBufferStorage(id_, region_size_ * frames, nullptr, flags);
+			data_ = (std::byte*)glMapNamedBufferRange(id_, 0, region_size_ * frames, flags);
+			if(data_ == nullptr) ::util::fail_error("Failed to map stream buffer of {} bytes.", region_size_ * frames);
+		}
+
+		/* replace the buffer with one that has regions of at least `size`. the
+		 * new one is created first, so its `id` differs from the old one's. */
+		void grow_(size_t size) {
+			// gl keeps the old buffer alive for as long as queued commands use it.
+			for(auto &fence : fences_) {
+				if(fence != nullptr) glDeleteSync(fence);
+				fence = nullptr;
+			}
+			GLuint old = id_;
+			create_(std::max(region_size_ * 2, size));
+			glUnmapNamedBuffer(old);
+			glDeleteBuffers(1, &old);
+			cursor_ = 0;
+		}
+	public:
+		void init(size_t region_size) { create_(region_size); }
+
+		void deinit() {
+			for(auto &fence : fences_) wait_(fence);
+			glUnmapNamedBuffer(id_);
+			glDeleteBuffers(1, &id_);
+			id_ = 0;
+			data_ = nullptr;
+		}
+
+		/* move on to the next region, waiting for the gpu to be done with it. */
+		void begin_frame() {
+			frame_ = (frame_ + 1) % frames;
+			wait_(fences_[frame_]);
+			cursor_ = 0;
+		}
+
+		/* fence the region of this frame, after its last use was submitted. */
+		void end_frame() {
+			fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		/* make room for `size` more bytes in this frame's region, so that
+		 * allocations adding up to that (with their alignment) keep the buffer. */
+		void reserve(size_t size) {
+			if(cursor_ + size > region_size_) grow_(size);
+		}
+
+		/* `size` bytes of this frame's region. if they don't fit, the buffer is
+		 * replaced with a bigger one (see `reserve`). that leaves the earlier
+		 * ranges of this frame in the old buffer and unbinds it, so use them
+		 * before allocating again. */
+		range allocate(size_t size, size_t alignment = 16) {
+			size_t offset = (cursor_ + alignment - 1) / alignment * alignment;
+			if(offset + size > region_size_) {
+				grow_(size);
+				offset = 0;
+			}
+			cursor_ = offset + size;
+			size_t base = frame_ * region_size_;
+			return { data_ + base + offset, GLintptr(base + offset) };
+		}
+
+		GLuint id() const { return id_; }
+	};
+
+	/* draws collected over a frame, sorted so that draws sharing state end up
+	 * next to each other. each draw gets a 64-bit key holding, from the top
+	 * bit down, its pass, program, material, texture set, mesh and view depth.
+	 * ids wider than their field wrap, which makes the order worse but never
+	 * the draws wrong, the renderer still compares the real state it binds. */
+	class render_queue {
+	public:
+		static constexpr int depth_bits = 16, mesh_bits = 12, texture_set_bits = 8,
+			material_bits = 12, program_bits = 12, pass_bits = 4;
+		static constexpr int mesh_shift = depth_bits;
+		static constexpr int texture_set_shift = mesh_shift + mesh_bits;
+		static constexpr int material_shift = texture_set_shift + texture_set_bits;
+		static constexpr int program_shift = material_shift + material_bits;
+		static constexpr int pass_shift = program_shift + program_bits;
+		static_assert(pass_shift + pass_bits == 64);
+
+		struct item {
+			const ::gfx::mesh *mesh;
+			::gfx::material *material;
+			glm::mat4 model;
+			uint32_t lod;
+		};
+
+		struct entry {
+			uint64_t key;
+			uint32_t index; /* into the items. */
+		};
+
+		/* `depth` is the view depth, drawn front to back. for positive floats
+		 * the bits grow with the value, so the top ones are a coarse depth
+		 * without knowing the depth range. */
+		static constexpr uint64_t make_key(
+			uint32_t pass, uint32_t program, uint32_t material,
+			uint32_t texture_set, uint32_t mesh, float depth
+		) {
+			auto field = [](uint64_t v, int bits, int shift) { return (v & ((uint64_t(1) << bits) - 1)) << shift; };
+			uint32_t depth_key = std::bit_cast<uint32_t>(std::max(depth, 0.0f)) >> (31 - depth_bits);
+			return field(pass, pass_bits, pass_shift) | field(program, program_bits, program_shift)
+				| field(material, material_bits, material_shift) | field(texture_set, texture_set_bits, texture_set_shift)
+				| field(mesh, mesh_bits, mesh_shift) | field(depth_key, depth_bits, 0);
+		}
+
+		/* program, material, texture set and mesh changes between neighbouring
+		 * keys, i.e. the binds drawing them in that order takes. */
+		template<typename Keys>
+		static size_t count_state_changes(const Keys &keys) {
+			auto changes = [](uint64_t a, uint64_t b) {
+				uint64_t diff = a ^ b;
+				auto differs = [&](int bits, int shift) { return size_t((diff >> shift & ((uint64_t(1) << bits) - 1)) != 0); };
+				return differs(program_bits, program_shift) + differs(material_bits, material_shift)
+					+ differs(texture_set_bits, texture_set_shift) + differs(mesh_bits, mesh_shift);
+			};
+			size_t count = 0;
+			uint64_t last = 0;
+			bool first = true;
+			for(uint64_t key : keys) {
+				count += first ? 4 : changes(last, key);
+				last = key;
+				first = false;
+			}
+			return count;
+		}
+
+		void push(uint64_t key, const item &draw) {
+			entries_.push_back({ key, uint32_t(items_.size()) });
+			items_.push_back(draw);
+		}
+
+		/* sort the entries by key. also counts the state changes before and after. */
+		void sort() {
+			submitted_state_changes = count_state_changes(entries_ | std::views::transform(&entry::key));
+			::util::radix_sort(entries_, scratch_);
+			sorted_state_changes = count_state_changes(entries_ | std::views::transform(&entry::key));
+		}
+
+		void clear() {
+			items_.clear();
+			entries_.clear();
+		}
+
+		std::span<const entry> entries() const { return entries_; }
+		const item &operator[](uint32_t index) const { return items_[index]; }
+		size_t size() const { return entries_.size(); }
+		bool empty() const { return entries_.empty(); }
+
+		/* of the last `sort`, in submission and in sorted order. */
+		size_t submitted_state_changes = 0, sorted_state_changes = 0;
+	private:
+		std::vector<item> items_;
+		std::vector<entry> entries_, scratch_;
+	};
+
 	class renderer {
 		GLuint bound_vao = 0, bound_program = 0;
+		const ::gfx::shader *bound_shader = nullptr;
 		bool depth_test = false;
+		bool face_culling = false; /* of back faces, see `set_face_culling`. */
+		glm::mat4 view_projection { 1.0f };
+		glm::vec2 viewport_size { 1.0f };
 
 		::res::res_manager &resman;
 
+		::gfx::box_batch cull_batch_; /* see `cull`. */
+
+		::gfx::render_queue queue_; /* see `submit`. */
+		const ::gfx::material *bound_material_ = nullptr; /* while flushing `queue_`. */
+
+		/* per frame and per object uniforms, and the indirect commands and draw
+		 * data of `flush`. */
+		::gfx::stream_buffer stream_;
+		GLint storage_alignment_ = 256; /* of shader storage buffer ranges. */
+		GLint uniform_alignment_ = 256; /* of uniform buffer ranges. */
+		GLuint frame_buffer_ = 0; /* the buffer the `frame_data` is in, 0 when it has to be written again. */
+
+		/* the std140 `Frame` block of the default shaders. */
+		struct frame_data {
+			glm::mat4 view_projection;
+			glm::vec4 sun_direction;
+			glm::vec4 sun_color;
+		};
+
+		glm::vec3 sun_direction_ { 0.4319342f, 0.8638684f, -0.25916055f };
+		glm::vec4 sun_color_ { 1.0f };
+
+		/* what `glMultiDrawElementsIndirect` reads. */
+		struct indirect_command {
+			GLuint count, instance_count, first_index;
+			GLint base_vertex;
+			GLuint base_instance;
+		};
+
+		/* the std430 `DrawData` of data/shaders/default/vert.glsl. */
+		struct draw_data {
+			glm::mat4 transform;
+			glm::vec4 position_scale;
+			glm::vec4 position_offset; /* w is 1 for octahedral normals. */
+		};
+
+		/* draws of the meshlets that survived culling, see `render_meshlets_`. */
+		std::vector<GLsizei> draw_counts_;
+		std::vector<const void*> draw_offsets_;
+		std::vector<GLint> draw_base_vertices_;
+
 		void bind_vao_(GLuint vao) {
 			if(bound_vao != vao)
 				glBindVertexArray(bound_vao = vao);
@@ -1232,60 +5383,442 @@ namespace gfx {
 			depth_test = enabled;
 		}
 
+		void bind_mesh_(const ::gfx::mesh &mesh) {
+			bind_vao_(mesh.vao);
+			if(bound_shader != nullptr && bound_shader->draws_indirect)
+				glProgramUniform1i(bound_program, ::gfx::shader::draw_base_location, -1);
+			if(bound_shader != nullptr && bound_shader->decodes_vertex_format) {
+				glProgramUniform3fv(bound_program, ::gfx::vertex_format::position_scale_location, 1, glm::value_ptr(mesh.position_scale));
+				glProgramUniform3fv(bound_program, ::gfx::vertex_format::position_offset_location, 1, glm::value_ptr(mesh.position_offset));
+				glProgramUniform1i(bound_program, ::gfx::vertex_format::octahedral_normal_location,
+					mesh.format.normal == ::gfx::vertex_format::normal_type::octahedral);
+			}
+		}
+
+		/* the meshlets of `lod` that are in the frustum and not backfacing,
+		 * neighbouring ones joined into one draw. */
+		void collect_meshlets_(const ::gfx::mesh &mesh, size_t lod, const glm::mat4 &model) {
+			glm::mat4 model_view_projection = view_projection * model;
+			auto frustum = ::gfx::frustum::from_matrix(model_view_projection);
+			// the camera is the point the model view projection sends to infinity.
+			glm::vec4 eye = glm::inverse(model_view_projection) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+			bool perspective = std::abs(eye.w) > 1e-12f;
+			glm::vec3 camera = glm::vec3(eye) / eye.w;
+
+			draw_counts_.clear();
+			draw_offsets_.clear();
+			draw_base_vertices_.clear();
+			const auto &level = mesh.lods[std::min(lod, mesh.lods.size() - 1)];
+			for(const auto &sub : std::span(mesh.submeshes).subspan(level.first_submesh, level.submesh_count)) {
+				for(const auto &m : std::span(mesh.meshlets).subspan(sub.first_meshlet, sub.meshlet_count)) {
+					++stats.meshlets;
+					if(!frustum.intersects(m.bounds)) {
+						++stats.meshlets_outside;
+						continue;
+					}
+					if(face_culling && perspective && ::gfx::cluster::backfacing(m, camera)) {
+						++stats.meshlets_backfacing;
+						continue;
+					}
+					const void *offset = (const void*)(mesh.index_offset + uintptr_t(m.first_index) * mesh.index_size);
+					GLint base_vertex = mesh.first_vertex + sub.base_vertex;
+					if(!draw_counts_.empty() && draw_base_vertices_.back() == base_vertex
+					&& (const std::byte*)draw_offsets_.back() + size_t(draw_counts_.back()) * mesh.index_size == offset) {
+						draw_counts_.back() += m.index_count;
+					} else {
+						draw_counts_.push_back(m.index_count);
+						draw_offsets_.push_back(offset);
+						draw_base_vertices_.push_back(base_vertex);
+					}
+				}
+			}
+		}
+
+		void render_meshlets_(const ::gfx::mesh &mesh, size_t lod, const glm::mat4 &model) {
+			collect_meshlets_(mesh, lod, model);
+			if(draw_counts_.empty()) return;
+			++stats.draw_calls;
+			glMultiDrawElementsBaseVertex((GLenum)mesh.mode, draw_counts_.data(),
+				mesh.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+				draw_offsets_.data(), draw_counts_.size(), draw_base_vertices_.data());
+		}
+
+		bool in_frustum_(const ::gfx::mesh &mesh, const glm::mat4 &model) {
+			if(!::gfx::frustum::from_matrix(view_projection * model).intersects(mesh.bounding_box)) {
+				++stats.objects_culled;
+				return false;
+			}
+			++stats.objects_visible;
+			return true;
+		}
+
+		/* draw `lod` of `mesh` with whatever object data is bound. */
+		void draw_(const ::gfx::mesh &mesh, size_t lod) {
+			bind_mesh_(mesh);
+			if(mesh.indexed) {
+				GLenum type = mesh.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+				const auto &level = mesh.lods[std::min(lod, mesh.lods.size() - 1)];
+				for(const auto &sub : std::span(mesh.submeshes).subspan(level.first_submesh, level.submesh_count)) {
+					++stats.draw_calls;
+					glDrawElementsBaseVertex((GLenum)mesh.mode, sub.index_count, type,
+						(const void*)(mesh.index_offset + uintptr_t(sub.first_index) * mesh.index_size),
+						mesh.first_vertex + sub.base_vertex);
+				}
+			} else {
+				++stats.draw_calls;
+				glDrawArrays((GLenum)mesh.mode, mesh.first_vertex, mesh.vertex_count);
+			}
+		}
+
+		void render_(const ::gfx::mesh &mesh, size_t lod, const glm::mat4 &model) {
+			if(!cull_meshlets || mesh.meshlets.empty()) return draw_(mesh, lod);
+			bind_mesh_(mesh);
+			render_meshlets_(mesh, lod, model);
+		}
+
+		/* the `Object` blocks of the default shaders, a model matrix each. */
+		size_t object_stride_() const {
+			return (sizeof(glm::mat4) + uniform_alignment_ - 1) / uniform_alignment_ * uniform_alignment_;
+		}
+
+		/* make room in `stream_` for `size` bytes in up to `allocations`
+		 * allocations, and write and bind the frame data if it isn't in the
+		 * stream's current buffer yet. */
+		void reserve_(size_t size, size_t allocations) {
+			size_t alignment = std::max(storage_alignment_, uniform_alignment_);
+			stream_.reserve(size + (allocations + 1) * alignment + sizeof(frame_data));
+			if(frame_buffer_ == stream_.id()) return;
+			auto block = stream_.allocate(sizeof(frame_data), uniform_alignment_);
+			*(frame_data*)block.data = { view_projection, glm::vec4(sun_direction_, 0.0f), sun_color_ };
+			glBindBufferRange(GL_UNIFORM_BUFFER, ::gfx::shader::frame_binding, stream_.id(), block.offset, sizeof(frame_data));
+			frame_buffer_ = stream_.id();
+		}
+
+		/* write `model` as the `index`th object of `block` and bind it. */
+		void bind_object_(const ::gfx::stream_buffer::range &block, size_t index, const glm::mat4 &model) {
+			size_t offset = index * object_stride_();
+			*(glm::mat4*)(block.data + offset) = model;
+			glBindBufferRange(GL_UNIFORM_BUFFER, ::gfx::shader::object_binding, stream_.id(), block.offset + offset, sizeof(glm::mat4));
+		}
+
+		/* write `model` as the only object of a new block and bind it. */
+		void bind_model_(const glm::mat4 &model) {
+			reserve_(object_stride_(), 1);
+			bind_object_(stream_.allocate(object_stride_(), uniform_alignment_), 0, model);
+		}
+
+		/* at most how many indirect commands `append_commands_` writes for `item`. */
+		static size_t max_commands_(const ::gfx::render_queue::item &item) {
+			const auto &mesh = *item.mesh;
+			if(!mesh.indexed) return 0;
+			const auto &level = mesh.lods[std::min<size_t>(item.lod, mesh.lods.size() - 1)];
+			size_t count = 0;
+			for(const auto &sub : std::span(mesh.submeshes).subspan(level.first_submesh, level.submesh_count))
+				count += std::max<size_t>(sub.meshlet_count, 1);
+			return count;
+		}
+
+		/* write the draws of `item` as indirect commands, each with a copy of its draw data. */
+		size_t append_commands_(const ::gfx::render_queue::item &item, indirect_command *commands, draw_data *draws) {
+			const auto &mesh = *item.mesh;
+			draw_data data {
+				view_projection * item.model,
+				glm::vec4(mesh.position_scale, 0.0f),
+				glm::vec4(mesh.position_offset, mesh.format.normal == ::gfx::vertex_format::normal_type::octahedral),
+			};
+			GLuint first_index = mesh.index_offset / mesh.index_size;
+			size_t count = 0;
+			if(cull_meshlets && !mesh.meshlets.empty()) {
+				collect_meshlets_(mesh, item.lod, item.model);
+				for(size_t i = 0; i < draw_counts_.size(); ++i) {
+					commands[count] = { GLuint(draw_counts_[i]), 1, GLuint(uintptr_t(draw_offsets_[i]) / mesh.index_size), draw_base_vertices_[i], 0 };
+					draws[count++] = data;
+				}
+				return count;
+			}
+			const auto &level = mesh.lods[std::min<size_t>(item.lod, mesh.lods.size() - 1)];
+			for(const auto &sub : std::span(mesh.submeshes).subspan(level.first_submesh, level.submesh_count)) {
+				commands[count] = { sub.index_count, 1, first_index + sub.first_index, mesh.first_vertex + sub.base_vertex, 0 };
+				draws[count++] = data;
+			}
+			return count;
+		}
+
 	public:
+		/* how many pixels off the full detail mesh `select_lod` lets a lod be. */
+		float lod_pixel_error = 1.0f;
+		/* cull the meshlets of meshes drawn with a model matrix, against the
+		 * frustum and, with `set_face_culling`, by their normal cones. */
+		bool cull_meshlets = true;
+
+		/* counted since `pre_render`. */
+		struct stats_type {
+			size_t objects_visible = 0, objects_culled = 0; /* by `cull`, `submit` and `render` with a model matrix. */
+			size_t meshlets = 0, meshlets_outside = 0, meshlets_backfacing = 0;
+			size_t draws = 0; /* items drawn by `flush`. */
+			size_t draw_calls = 0, indirect_commands = 0; /* gl draw calls, and the commands of multi draws among them. */
+			size_t instances = 0; /* drawn by `render_instanced`. */
+			/* program, material, texture set and mesh changes `flush` made, and
+			 * how many fewer that is than drawing in submission order. */
+			size_t state_changes = 0, state_changes_saved = 0;
+		} stats;
+
 		renderer(::res::res_manager &m) : resman(m) {}
 
 		void init() {
 			depth_test = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+			face_culling = glIsEnabled(GL_CULL_FACE) == GL_TRUE;
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment_);
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment_);
+			stream_.init(1 << 20);
+		}
+
+		void deinit() {
+			stream_.deinit();
 		}
 
 		void pre_render() {
 			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			set_depth_test(true);
+			stats = {};
+			stream_.begin_frame();
+			frame_buffer_ = 0;
+		}
+
+		/* cull back faces, for single-sided meshes. this also lets meshlets be
+		 * culled by their normal cones, which would drop visible back faces otherwise. */
+		void set_face_culling(bool enabled) {
+			if(face_culling == enabled) return;
+			if(enabled) glEnable(GL_CULL_FACE);
+			else glDisable(GL_CULL_FACE);
+			face_culling = enabled;
 		}
 
 		void viewport(glm::vec2 vp) {
+			viewport_size = vp;
 			glViewport(0.0f, 0.0f, vp.x, vp.y);
 		}
 
+		/* the camera `select_lod` measures screen sizes with. */
+		void set_view_projection(const glm::mat4 &matrix) {
+			view_projection = matrix;
+			frame_buffer_ = 0;
+		}
+
+		/* the light of the default shaders. */
+		void set_sun(const glm::vec3 &direction, const glm::vec4 &color) {
+			sun_direction_ = direction;
+			sun_color_ = color;
+			frame_buffer_ = 0;
+		}
+
+		/* the coarsest lod of `mesh` whose error, projected from the nearest
+		 * point of the mesh's bounding sphere, stays within `lod_pixel_error`. */
+		size_t select_lod(const ::gfx::mesh &mesh, const glm::mat4 &model) const {
+			if(mesh.lods.size() <= 1) return 0;
+			glm::vec4 center = view_projection * model * glm::vec4(mesh.bounding_sphere.center, 1.0f);
+			float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+			float distance = center.w - mesh.bounding_sphere.radius * scale; /* clip w is the view depth. */
+			if(distance <= 0.0f) return 0;
+			// for a rigid view the y row of the view projection is as long as the projection's y scale.
+			glm::vec3 row_y { view_projection[0][1], view_projection[1][1], view_projection[2][1] };
+			float pixels_per_unit = glm::length(row_y) / distance * viewport_size.y * 0.5f;
+			size_t lod = 0;
+			while(lod + 1 < mesh.lods.size() && mesh.lods[lod + 1].error * scale * pixels_per_unit <= lod_pixel_error) ++lod;
+			return lod;
+		}
+
 		void post_render() {
+			stream_.end_frame();
+		}
 
+		/* append to `visible` the indices of the `bounds` that are in the view
+		 * frustum once transformed by the matching `models`. */
+		void cull(std::span<const ::gfx::aabb> bounds, std::span<const glm::mat4> models, std::vector<uint32_t> &visible) {
+			assert(bounds.size() == models.size());
+			cull_batch_.clear();
+			for(size_t i = 0; i < bounds.size(); ++i) cull_batch_.push(bounds[i].transformed(models[i]));
+			size_t before = visible.size();
+			::gfx::frustum::from_matrix(view_projection).cull(cull_batch_, visible);
+			stats.objects_visible += visible.size() - before;
+			stats.objects_culled += bounds.size() - (visible.size() - before);
 		}
 
-		void render(const ::gfx::mesh &mesh) {
-			bind_vao_(mesh.vao);
-			if(mesh.indexed) {
-				glDrawElements((GLenum)mesh.mode, mesh.index_count, GL_UNSIGNED_SHORT, nullptr);
-			} else {
-				glDrawArrays((GLenum)mesh.mode, 0, mesh.vertex_count);
+		/* draw `mesh` with `model` as its object data, unless it is outside the view frustum. */
+		void render(const ::gfx::mesh &mesh, const glm::mat4 &model) {
+			if(!in_frustum_(mesh, model)) return;
+			bind_model_(model);
+			render_(mesh, select_lod(mesh, model), model);
+		}
+
+		/* queue `mesh` to be drawn with `material` by `flush`, unless it is
+		 * outside the view frustum. lower passes are drawn first. */
+		void submit(const ::gfx::mesh &mesh, ::gfx::material &material, const glm::mat4 &model, uint32_t pass = 0) {
+			if(!in_frustum_(mesh, model)) return;
+			const auto &shader = material.shader.get_from(resman);
+			uint32_t texture_set = 0;
+			for(const auto &texture : material.textures)
+				texture_set = (texture_set * 31 + texture.unit) * 31 + texture.texture.get_from(resman).id;
+			float depth = (view_projection * model * glm::vec4(mesh.bounding_sphere.center, 1.0f)).w;
+			queue_.push(
+				::gfx::render_queue::make_key(pass, shader.id, material.sort_id, texture_set, mesh.sort_id, depth),
+				{ &mesh, &material, model, uint32_t(select_lod(mesh, model)) });
+		}
+
+		/* draw everything submitted since the last flush, sorted by key. runs
+		 * of indexed meshes that share a material, vertex array, mode and index
+		 * size are drawn with one multi draw indirect, if the shader reads the
+		 * draw data (see data/shaders/default/vert.glsl). the commands and draw
+		 * data are written straight into `stream_`. other items get a draw of
+		 * their own, with their model matrix written to `stream_` as well and
+		 * bound as the `Object` block. */
+		void flush() {
+			queue_.sort();
+			stats.state_changes += queue_.sorted_state_changes;
+			if(queue_.submitted_state_changes > queue_.sorted_state_changes)
+				stats.state_changes_saved += queue_.submitted_state_changes - queue_.sorted_state_changes;
+			bound_material_ = nullptr; // params may have changed since the last flush.
+
+			size_t max_commands = 0, objects = 0;
+			for(const auto &entry : queue_.entries()) {
+				const auto &item = queue_[entry.index];
+				if(item.mesh->indexed && item.material->shader.get_from(resman).draws_indirect) max_commands += max_commands_(item);
+				else ++objects;
+			}
+			// draw data first, as it needs the bigger alignment.
+			size_t draws_size = max_commands * sizeof(draw_data);
+			size_t commands_size = max_commands * sizeof(indirect_command);
+			// one more object than needed, so that the Object block is bound to
+			// this frame's memory before the first draw, even multi draws.
+			reserve_(draws_size + commands_size + (objects + 1) * object_stride_(), 2);
+			auto object_block = stream_.allocate((objects + 1) * object_stride_(), uniform_alignment_);
+			size_t object_count = 0;
+			bind_object_(object_block, object_count++, glm::mat4(1.0f));
+			indirect_command *commands = nullptr;
+			draw_data *draws = nullptr;
+			GLintptr commands_offset = 0;
+			if(max_commands > 0) {
+				auto block = stream_.allocate(draws_size + commands_size, storage_alignment_);
+				draws = (draw_data*)block.data;
+				commands = (indirect_command*)(block.data + draws_size);
+				commands_offset = block.offset + draws_size;
+				glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ::gfx::shader::draw_data_binding, stream_.id(), block.offset, draws_size);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream_.id());
+			}
+
+			size_t command_count = 0, run_start = 0;
+			const ::gfx::mesh *run_mesh = nullptr; /* first of the run being collected. */
+			auto draw_run = [&] {
+				if(run_mesh != nullptr && command_count > run_start) {
+					glProgramUniform1i(bound_program, ::gfx::shader::draw_base_location, run_start);
+					glMultiDrawElementsIndirect((GLenum)run_mesh->mode,
+						run_mesh->index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+						(const void*)(commands_offset + run_start * sizeof(indirect_command)), command_count - run_start, 0);
+					++stats.draw_calls;
+					stats.indirect_commands += command_count - run_start;
+				}
+				run_start = command_count;
+				run_mesh = nullptr;
+			};
+
+			for(const auto &entry : queue_.entries()) {
+				const auto &item = queue_[entry.index];
+				const auto &mesh = *item.mesh;
+				++stats.draws;
+				if(bound_material_ != item.material) {
+					draw_run();
+					bind_material(*item.material);
+					bound_material_ = item.material;
+				}
+				if(!mesh.indexed || !bound_shader->draws_indirect) {
+					draw_run();
+					bind_object_(object_block, object_count++, item.model);
+					render_(mesh, item.lod, item.model);
+					continue;
+				}
+				if(run_mesh != nullptr && (run_mesh->vao != mesh.vao || run_mesh->mode != mesh.mode || run_mesh->index_size != mesh.index_size))
+					draw_run();
+				if(run_mesh == nullptr) {
+					run_mesh = &mesh;
+					bind_vao_(mesh.vao);
+				}
+				command_count += append_commands_(item, commands + command_count, draws + command_count);
+			}
+			draw_run();
+			queue_.clear();
+		}
+
+		/* draw `mesh` at `lod` with an identity model matrix, without culling. */
+		void render(const ::gfx::mesh &mesh, size_t lod = 0) {
+			bind_model_(glm::mat4(1.0f));
+			draw_(mesh, lod);
+		}
+
+		/* draw `mesh` with `material` once for each of `models`, with one draw
+		 * per submesh of `lod`. the matrices are copied into `stream_` as they
+		 * are, for the shader to read from its instance buffer (see
+		 * data/shaders/instanced/vert.glsl). neither the instances nor the
+		 * meshlets are culled, see `cull` for the former. */
+		void render_instanced(const ::gfx::mesh &mesh, ::gfx::material &material, std::span<const glm::mat4> models, size_t lod = 0) {
+			if(models.empty()) return;
+			reserve_(models.size_bytes(), 1);
+			auto block = stream_.allocate(models.size_bytes(), storage_alignment_);
+			std::memcpy(block.data, models.data(), models.size_bytes());
+			glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ::gfx::shader::instance_binding, stream_.id(), block.offset, models.size_bytes());
+			bind_material(material);
+			bind_mesh_(mesh);
+			stats.instances += models.size();
+			if(!mesh.indexed) {
+				++stats.draw_calls;
+				glDrawArraysInstanced((GLenum)mesh.mode, mesh.first_vertex, mesh.vertex_count, models.size());
+				return;
+			}
+			GLenum type = mesh.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+			const auto &level = mesh.lods[std::min(lod, mesh.lods.size() - 1)];
+			for(const auto &sub : std::span(mesh.submeshes).subspan(level.first_submesh, level.submesh_count)) {
+				++stats.draw_calls;
+				glDrawElementsInstancedBaseVertex((GLenum)mesh.mode, sub.index_count, type,
+					(const void*)(mesh.index_offset + uintptr_t(sub.first_index) * mesh.index_size),
+					models.size(), mesh.first_vertex + sub.base_vertex);
 			}
 		}
 
-		void render(const ::gfx::model &model) {
+		/* draw every part of `model` with `transform` as its object data, without culling. */
+		void render(const ::gfx::model &model, const glm::mat4 &transform = glm::mat4(1.0f)) {
+			bind_model_(transform);
 			for(const auto &[mesh, material] : model.parts) {
-				bind_program_(material.get_from(resman).shader.get_from(resman).id);
-				render(mesh.get_from(resman));
+				bind_shader(material.get_from(resman).shader.get_from(resman));
+				draw_(mesh.get_from(resman), 0);
 			}
 		}
 
 		void bind_material(::gfx::material &material) {
 			auto &shader = material.shader.get_from(resman);
 			bind_shader(shader);
-			for(auto &[name, param] : material.params) {
+			if(material.slots_program != shader.id) {
+				// first bind since the material or its shader was (re)loaded.
+				for(auto &param : material.params) {
+					param.slot = ::gfx::material::unresolved_slot;
+					param.dirty = true;
+				}
+				material.slots_program = shader.id;
+			}
+			for(auto &param : material.params) {
 				if(!param.dirty) continue;
+				if(param.slot == ::gfx::material::unresolved_slot) param.slot = shader.uniform_slot(param.name);
 				if(std::holds_alternative<int>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<int>(param.value));
+					shader.set_uniform(param.slot, std::get<int>(param.value));
 				} else if(std::holds_alternative<float>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<float>(param.value));
+					shader.set_uniform(param.slot, std::get<float>(param.value));
 				} else if(std::holds_alternative<glm::vec2>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<glm::vec2>(param.value));
+					shader.set_uniform(param.slot, std::get<glm::vec2>(param.value));
 				} else if(std::holds_alternative<glm::vec3>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<glm::vec3>(param.value));
+					shader.set_uniform(param.slot, std::get<glm::vec3>(param.value));
 				} else if(std::holds_alternative<glm::vec4>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<glm::vec4>(param.value));
+					shader.set_uniform(param.slot, std::get<glm::vec4>(param.value));
 				} else if(std::holds_alternative<glm::mat4>(param.value)) {
-					shader.set_uniform(name.c_str(), std::get<glm::mat4>(param.value));
+					shader.set_uniform(param.slot, std::get<glm::mat4>(param.value));
 				} else assert(false && "bad material param value variant type");
 				param.dirty = false;
 			}
@@ -1295,6 +5828,7 @@ namespace gfx {
 		}
 
 		void bind_shader(const ::gfx::shader &shader) {
+			bound_shader = &shader;
 			bind_program_(shader.id);
 		}
 
@@ -1341,6 +5875,122 @@ struct transform {
 	}
 };
 
+#ifdef GAEM_COOKER
+/* a grid of quads as .obj text, roughly `megabytes` long. */
+static std::string synthetic_obj(size_t megabytes) {
+	size_t side = std::max<size_t>(2, std::sqrt(megabytes * (1 << 20) / 160.0));
+	std::string out;
+	out.reserve(megabytes << 20);
+	for(size_t y = 0; y < side; ++y)
+		for(size_t x = 0; x < side; ++x)
+			out += fmt::format("v {:.6f} {:.6f} {:.6f}\nvt {:.6f} {:.6f}\nvn 0.0 1.0 0.0\n",
+				x * 0.01, std::sin(x * 0.1) * std::cos(y * 0.1), y * 0.01, x / double(side), y / double(side));
+	for(size_t y = 0; y + 1 < side; ++y) {
+		for(size_t x = 0; x + 1 < side; ++x) {
+			size_t i = y * side + x + 1;
+			out += fmt::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2} {3}/{3}/{3}\n", i, i + 1, i + side + 1, i + side);
+		}
+	}
+	return out;
+}
+
+/* time gfx::obj against tinyobj on files or `synthetic:<megabytes>` inputs. */
+static void bench_obj(std::span<char*> inputs) {
+	auto best_of = [](auto &&f) {
+		double best = INFINITY;
+		for(int i = 0; i < 5; ++i) {
+			auto start = stdch::steady_clock::now();
+			f();
+			best = std::min(best, stdch::duration<double>(stdch::steady_clock::now() - start).count());
+		}
+		return best;
+	};
+	for(strv input : inputs) {
+		std::string text;
+		if(input.starts_with("synthetic:")) {
+			text = synthetic_obj(std::stoul(std::string(input.substr(10))));
+		} else {
+			auto file = ::util::read_file(input);
+			text.assign(file.begin(), file.end());
+		}
+		size_t triangles = 0;
+		double ours = best_of([&] { triangles = gfx::obj::parse(text).indices.size() / 3; });
+		double theirs = best_of([&] {
+			tinyobj::attrib_t attrib;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+			std::string warn, err;
+			std::istringstream stream(text);
+			if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream))
+				::util::fail_error("Failed to load .obj file:\n{}", warn + err);
+		});
+		double megabytes = text.size() / double(1 << 20);
+		fmt::print("{}: {:.1f} MiB, {} triangles\n", input, megabytes, triangles);
+		fmt::print("  gfx::obj  {:8.2f} ms {:8.1f} MiB/s\n", ours * 1000, megabytes / ours);
+		fmt::print("  tinyobj   {:8.2f} ms {:8.1f} MiB/s\n", theirs * 1000, megabytes / theirs);
+	}
+}
+
+/* sort `count` random draws with gfx::render_queue and with std::stable_sort,
+ * and count the state changes of drawing them in submission and sorted order. */
+static void bench_queue(size_t count) {
+	std::mt19937 rng(1234);
+	auto random = [&](uint32_t n) { return std::uniform_int_distribution<uint32_t>(0, n - 1)(rng); };
+	gfx::render_queue queue;
+	for(size_t i = 0; i < count; ++i) {
+		uint64_t key = gfx::render_queue::make_key(random(2), random(8), random(64), random(32), random(256), random(10000) * 0.01f);
+		queue.push(key, { nullptr, nullptr, glm::mat4(1.0f), 0 });
+	}
+	auto submitted = std::vector(queue.entries().begin(), queue.entries().end());
+	queue.sort();
+	size_t submitted_changes = queue.submitted_state_changes, sorted_changes = queue.sorted_state_changes;
+
+	auto best_of = [](auto &&f) {
+		double best = INFINITY;
+		for(int i = 0; i < 5; ++i) {
+			auto start = stdch::steady_clock::now();
+			f();
+			best = std::min(best, stdch::duration<double>(stdch::steady_clock::now() - start).count());
+		}
+		return best;
+	};
+	// a radix sort does the same work whatever the order, so sorting again is a fair measure.
+	double radix = best_of([&] { queue.sort(); });
+	std::vector<gfx::render_queue::entry> entries;
+	double comparison = best_of([&] {
+		entries = submitted;
+		std::ranges::stable_sort(entries, {}, &gfx::render_queue::entry::key);
+	});
+	assert(std::ranges::equal(queue.entries(), entries, {}, &gfx::render_queue::entry::index, &gfx::render_queue::entry::index));
+
+	fmt::print("{} draws\n", count);
+	fmt::print("  radix sort   {:8.3f} ms\n", radix * 1000);
+	fmt::print("  stable_sort  {:8.3f} ms\n", comparison * 1000);
+	fmt::print("  state changes: {} submitted, {} sorted ({} saved)\n",
+		submitted_changes, sorted_changes, submitted_changes - sorted_changes);
+}
+
+/* offline asset cooker, see gfx::cooked. usage: cook <source> <output>
+ * or cook --bench-obj <file.obj | synthetic:<megabytes>>...
+ * or cook --bench-queue [draws] */
+int main(int argc, char *argv[]) {
+	if(argc >= 2 && argv[1] == "--bench-obj"sv) {
+		bench_obj(std::span(argv + 2, argc - 2));
+		return 0;
+	}
+	if(argc >= 2 && argv[1] == "--bench-queue"sv) {
+		bench_queue(argc >= 3 ? std::stoul(argv[2]) : 50000);
+		return 0;
+	}
+	if(argc != 3) ::util::fail_error("Usage: {} <source> <output>", argv[0]);
+	stdfs::path source = argv[1], output = argv[2];
+	auto ext = source.extension();
+	if(ext == ".obj" || ext == ".gltf" || ext == ".glb") gfx::mesh::cook(source, output);
+	else if(ext == ".png") gfx::texture::cook(source, output);
+	else ::util::fail_error("Don't know how to cook: {}", source);
+	return 0;
+}
+#else
 int main(int argc, char *argv[]) {
 	clog.set_spread_out(0);
 	std::atexit([](){ clog.flush(); });
@@ -1359,13 +6009,33 @@ int main(int argc, char *argv[]) {
 	resman.register_provider<gfx::mesh>("mesh");
 	resman.register_provider<gfx::model>("model");
 	resman.register_provider<gfx::texture>("texture");
-	resman.load_from_file("data/resman.json");
-	auto default_shader = resman.get_resource<gfx::shader>("shader.default");
-	auto default_material = resman.get_resource<gfx::material>("material.default");
-	default_shader.preload_from(resman);
-	default_material.preload_from(resman);
-
-	std::vector<std::string> mesh_names = { "mesh.cube", "mesh.house" };
+	// prefer the compiled manifest (see resman_gen.py) when it has been built
+	// since the json one last changed, like cooked assets (see gfx::cooked::find).
+	stdfs::path manifest = "data/resman.json";
+	std::error_code manifest_ec;
+	auto compiled_time = stdfs::last_write_time("build/resman.bin", manifest_ec);
+	if(!manifest_ec) {
+		if(compiled_time >= stdfs::last_write_time(manifest)) manifest = "build/resman.bin";
+		else clog.println("Warning: build/resman.bin is older than {}, loading that instead.", manifest);
+	}
+	resman.load_from_file(manifest);
+	resman.enable_hot_reload();
+	resman.set_budget({ .cpu_bytes = 64 << 20, .gpu_bytes = 256 << 20 });
+	auto default_shader = resman.get_resource<gfx::shader>("shader.default"_sid);
+	auto default_material = resman.get_resource<gfx::material>("material.default"_sid);
+	default_shader.preload_async(resman);
+	default_material.preload_async(resman).wait(resman);
+	default_material.acquire_from(resman); // used every frame, never evict.
+	auto instanced_material = resman.get_resource<gfx::material>("material.instanced"_sid);
+	instanced_material.preload_async(resman);
+
+	std::vector<std::string> mesh_names = { "mesh.cube", "mesh.house", "mesh.cube.glb" };
+	std::vector<res_ref<gfx::mesh>> meshes;
+	std::vector<res::res_manager::load_handle> mesh_loads;
+	for(const auto &name : mesh_names) {
+		meshes.push_back(resman.get_resource<gfx::mesh>(name));
+		mesh_loads.push_back(meshes.back().preload_async(resman));
+	}
 	int current_mesh_index = 0;
 
 	gfx::renderer rend{resman};
@@ -1396,8 +6066,16 @@ int main(int argc, char *argv[]) {
 
 	bool right_left_key_was_down = false;
 
+	// a grid of instances of the current mesh, toggled with I.
+	std::vector<glm::mat4> grid;
+	for(int z = 0; z < 100; ++z)
+		for(int x = 0; x < 100; ++x)
+			grid.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(x - 50, -2, z - 50) * 3.0f));
+	bool show_grid = false, grid_key_was_down = false;
+
 	while(window.is_open()) {
 		gfx::backend_glfw::poll_events();
+		resman.update();
 		float current_time = gfx::backend_glfw::get_time();
 		float delta_time = current_time - last_time;
 
@@ -1428,14 +6106,24 @@ int main(int argc, char *argv[]) {
 			right_left_key_was_down = false;
 		}
 
-		default_material.get_from(resman).set("uTransform", cam.matrix() * trans.matrix());
+		if(window.get_key(73 /* i */)) {
+			if(!grid_key_was_down) show_grid = !show_grid;
+			grid_key_was_down = true;
+		} else {
+			grid_key_was_down = false;
+		}
+
+		rend.set_view_projection(cam.matrix());
 
-		auto current_mesh = resman.get_resource<gfx::mesh>(mesh_names[current_mesh_index]);
+		const auto &current_mesh = meshes[current_mesh_index];
 
 		rend.pre_render();
 		rend.viewport(window.size());
-		rend.bind_material(default_material.get_from(resman));
-		rend.render(current_mesh.get_from(resman));
+		if(mesh_loads[current_mesh_index].is_ready())
+			rend.submit(current_mesh.get_from(resman), default_material.get_from(resman), trans.matrix());
+		rend.flush();
+		if(show_grid && mesh_loads[current_mesh_index].is_ready())
+			rend.render_instanced(current_mesh.get_from(resman), instanced_material.get_from(resman), grid);
 		rend.post_render();
 
 		window.update();
@@ -1443,9 +6131,18 @@ int main(int argc, char *argv[]) {
 		last_mouse_pos = current_mouse_pos;
 	}
 
+	resman.print_provider_stats();
+	gfx::geometry_pool::print_stats();
+	resman.print_load_summary();
+	if(const char *path = std::getenv("GAEM_LOAD_TRACE"))
+		resman.write_load_trace(path);
+	default_material.release_from(resman);
 	resman.delete_all();
+	rend.deinit();
+	gfx::geometry_pool::delete_all();
 	window.deinit();
 	
 	gfx::backend_glfw::deinit();
 	return 0;
 }
+#endif